@@ -0,0 +1,112 @@
+#pragma once
+//
+//    FILE: ExponentialAverage.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: Arduino library to calculate the running average by means of a circular buffer
+//          exponential moving average without buffer, fixed point, shift only.
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  avg += (value - avg) * alpha, with alpha = 1 / 2^shift.
+//  The state is kept in fixed point with FRAC fraction bits in S,
+//  default Q16.16 in an uint32_t, so the update is a compare, a subtract
+//  and a shift, no float and no division (AVR friendly).
+//  RAM: one S plus min, max and count, independent of the smoothing.
+//
+//  T must be unsigned, S must hold max(T) << FRAC.
+
+
+#include "RunningAverage.h"
+
+
+namespace runningaverage
+{
+
+template <typename T = uint16_t, typename S = uint32_t, uint8_t FRAC = 16>
+class ExponentialAverage
+{
+public:
+  static_assert(sizeof(T) * 8 + FRAC <= sizeof(S) * 8, "ExponentialAverage state S too small for T and FRAC");
+
+  //  alpha = 1 / 2^shift, 0 = no smoothing.
+  explicit ExponentialAverage(const uint8_t shift = 3)
+  {
+    setShift(shift);
+    clear();
+  };
+
+  void     clear()
+  {
+    _state = 0;
+    _count = 0;
+    _min = 0;
+    _max = 0;
+  };
+
+  void     add(const T value) { addValue(value); };
+  //  the first value sets the average, no start up bias towards 0.
+  void     addValue(const T value)
+  {
+    S x = ((S)value) << FRAC;
+    if (_count == 0)
+    {
+      _state = x;
+      _min = _max = value;
+    }
+    else
+    {
+      //  unsigned, so branch on the sign of (x - state).
+      if (x >= _state) _state += (x - _state) >> _shift;
+      else             _state -= (_state - x) >> _shift;
+      if (value < _min) _min = value;
+      else if (value > _max) _max = value;
+    }
+    if (_count < 0xFFFFFFFF) _count++;
+  };
+
+  //  sets the average, like a window filled with value.
+  void     fillValue(const T value)
+  {
+    clear();
+    addValue(value);
+  };
+
+  //  rounded to nearest.
+  T        getAverage() const
+  {
+    return (T)((_state + (((S)1 << FRAC) >> 1)) >> FRAC);
+  };
+  T        getFastAverage() const { return getAverage(); };
+  //  fixed point state, FRAC fraction bits.
+  S        getRaw() const         { return _state; };
+
+  //  since clear()
+  T        getMin() const         { return _min; };
+  T        getMax() const         { return _max; };
+  uint32_t getCount() const       { return _count; };
+
+  //  alpha = 1 / 2^shift, shift <= FRAC keeps the fraction bits meaningful.
+  void     setShift(const uint8_t shift) { _shift = (shift > FRAC) ? FRAC : shift; };
+  uint8_t  getShift() const       { return _shift; };
+
+
+protected:
+  S        _state;
+  uint32_t _count;
+  T        _min;
+  T        _max;
+  uint8_t  _shift;
+};
+
+}  //  namespace runningaverage
+
+
+#if !defined(RA_NO_GLOBAL_NAMES)
+template <typename T = uint16_t, typename S = uint32_t, uint8_t FRAC = 16>
+using ExponentialAverage = runningaverage::ExponentialAverage<T, S, FRAC>;
+#endif
+
+
+//  -- END OF FILE --
+
@@ -2,82 +2,2022 @@
 //
 //    FILE: RunningAverage.h
 //  AUTHOR: Rob Tillaart
-// VERSION: 0.4.5
+// VERSION: 0.5.0
 //    DATE: 2011-01-30
 // PURPOSE: Arduino library to calculate the running average by means of a circular buffer
 //     URL: https://github.com/RobTillaart/RunningAverage
 //
 //  The library stores N individual values in a circular buffer,
 //  to calculate the running average.
+//
+//  0.5.0 turned the class into a template over the (integer) sample type T
+//  and the accumulator type A used for the running sum.
+//  The accumulator must be able to hold size * max(T) to be exact.
+//  Loops over the whole buffer use the kernels of RunningAverageSIMD.h
 
 
 #include "Arduino.h"
+#include "RunningAverageSIMD.h"
+
+#if !defined(__AVR__) && defined(__has_include)
+#if __has_include(<memory_resource>) && (__cplusplus >= 201703L)
+#include <memory_resource>
+#define RA_HAS_PMR                    1
+#endif
+#endif
+
+
+#define RUNNINGAVERAGE_LIB_VERSION    (F("0.5.0"))
+
+
+namespace runningaverage
+{
+
+//  compile time options, OR them into the third template parameter F.
+//  every option costs extra RAM and extra work in addValue().
+const uint16_t RA_MINMAX      = 0x0001;  //  O(1) getMinInBuffer() / getMaxInBuffer()
+const uint16_t RA_MOMENTS     = 0x0002;  //  O(1) variance, standard deviation, error, RMS
+const uint16_t RA_MOMENTS4    = 0x0004;  //  O(1) skewness + kurtosis, implies RA_MOMENTS
+const uint16_t RA_PREFIX      = 0x0008;  //  O(1) getAverageLast() / getAverageSubset()
+const uint16_t RA_RANGE       = 0x0010;  //  O(log N) min/max of any range of the buffer
+const uint16_t RA_QUOTIENT    = 0x0020;  //  getFastAverage() without division
+const uint16_t RA_HISTOGRAM   = 0x0040;  //  exact median / quantiles, 8 or 16 bit T, 128 KB
+const uint16_t RA_WEIGHTED    = 0x0080;  //  O(1) linearly weighted average
+const uint16_t RA_LOOKBACK    = 0x0100;  //  O(1) getAverageLast() for registered lengths
+
+//  RA_LOOKBACK, max number of registered lengths.
+const uint8_t  RA_LOOKBACKS   = 4;
+
+
+//  serialize() format, magic "RA" + version.
+const uint8_t  RA_SERIAL_VERSION = 1;
+
+
+//  rounding of getFastAverage()
+const uint8_t  RA_ROUND_FLOOR   = 0;     //  default, truncate
+const uint8_t  RA_ROUND_NEAREST = 1;     //  half up
+const uint8_t  RA_ROUND_BANKER  = 2;     //  half to even
+
+
+//  ring of buffer indices, used as monotonic deque for RA_MINMAX.
+//  holds every slot at most once so size elements suffice.
+class RA_Deque
+{
+public:
+  void     begin(uint16_t * buffer, uint16_t size) { _buf = buffer; _size = size; clear(); };
+  //  same content, moved to buffer, e.g. after a copy of the indices.
+  void     setBuffer(uint16_t * buffer) { _buf = buffer; };
+  void     clear()          { _head = 0; _len = 0; };
+  bool     empty() const    { return _len == 0; };
+  uint16_t front() const    { return _buf[_head]; };
+  uint16_t back() const     { return _buf[_slot(_len - 1)]; };
+  void     popFront()       { _head = _slot(1); _len--; };
+  void     popBack()        { _len--; };
+  void     pushBack(uint16_t idx) { _buf[_slot(_len)] = idx; _len++; };
+
+private:
+  uint16_t _slot(uint16_t offset) const
+  {
+    uint16_t s = _head + offset;
+    if (s >= _size) s -= _size;
+    return s;
+  };
+
+  uint16_t * _buf  = NULL;
+  uint16_t   _size = 0;
+  uint16_t   _head = 0;
+  uint16_t   _len  = 0;
+};
+
+
+//  allocator hooks for the buffers, e.g. a pool or an arena.
+//  deallocate() gets the same number of bytes as the allocate() call.
+//  NULL hooks use malloc() / free().
+struct RA_Allocator
+{
+  void *   (* allocate)(size_t bytes, void * context);
+  void     (* deallocate)(void * p, size_t bytes, void * context);
+  void *   context;
+};
+
+
+#if defined(RA_HAS_PMR)
+//  hosted builds, allocate from a std::pmr::memory_resource.
+inline void * ra_pmrAllocate(size_t bytes, void * context)
+{
+  std::pmr::memory_resource * resource = (std::pmr::memory_resource *) context;
+#if defined(__cpp_exceptions)
+  try { return resource->allocate(bytes, alignof(std::max_align_t)); }
+  catch (...) { return NULL; }
+#else
+  return resource->allocate(bytes, alignof(std::max_align_t));
+#endif
+}
+
+inline void ra_pmrDeallocate(void * p, size_t bytes, void * context)
+{
+  ((std::pmr::memory_resource *) context)->deallocate(p, bytes, alignof(std::max_align_t));
+}
+
+inline RA_Allocator ra_pmrAllocator(std::pmr::memory_resource * resource)
+{
+  RA_Allocator allocator = { ra_pmrAllocate, ra_pmrDeallocate, resource };
+  return allocator;
+}
+#endif
+
+
+//  attach() maps the ring of a blob as T array, only on little endian hosts.
+inline bool ra_littleEndian()
+{
+  const uint16_t one = 1;
+  return *((const uint8_t *) &one) == 1;
+}
 
 
-#define RUNNINGAVERAGE_LIB_VERSION    (F("0.4.5"))
+//  rotates array[0 .. number) left so array[first] becomes array[0].
+//  in place by three reversals, O(number), no extra memory.
+template <typename T>
+void ra_rotate(T * array, uint16_t number, uint16_t first)
+{
+  if ((first == 0) || (first >= number)) return;
+  for (uint16_t i = 0, j = first - 1; i < j; i++, j--)
+  {
+    T t = array[i]; array[i] = array[j]; array[j] = t;
+  }
+  for (uint16_t i = first, j = number - 1; i < j; i++, j--)
+  {
+    T t = array[i]; array[i] = array[j]; array[j] = t;
+  }
+  for (uint16_t i = 0, j = number - 1; i < j; i++, j--)
+  {
+    T t = array[i]; array[i] = array[j]; array[j] = t;
+  }
+}
 
 
+//  state of the options, RunningAverage derives from the variant F selects.
+//  the primary templates are the disabled options: no data members, so an
+//  empty base without RAM. Their names are static only so the if (F & option)
+//  branches compile, they are never used at runtime.
+template <uint8_t N, bool ON>
+struct RA_MomentsState
+{
+  static uint64_t _moment[N];
+};
+template <uint8_t N>
+struct RA_MomentsState<N, true>
+{
+  uint64_t _moment[N];
+};
+template <uint8_t N, bool ON> uint64_t RA_MomentsState<N, ON>::_moment[N];
+
+
+template <bool ON>
+struct RA_MinMaxState
+{
+  static uint16_t * _deques;
+  static RA_Deque   _minDeque;
+  static RA_Deque   _maxDeque;
+};
+template <>
+struct RA_MinMaxState<true>
+{
+  uint16_t * _deques;
+  RA_Deque   _minDeque;
+  RA_Deque   _maxDeque;
+};
+template <bool ON> uint16_t * RA_MinMaxState<ON>::_deques = NULL;
+template <bool ON> RA_Deque   RA_MinMaxState<ON>::_minDeque;
+template <bool ON> RA_Deque   RA_MinMaxState<ON>::_maxDeque;
+
+
+template <typename A, bool ON>
+struct RA_PrefixState
+{
+  static A * _prefix;
+  static A   _total;
+};
+template <typename A>
+struct RA_PrefixState<A, true>
+{
+  A *      _prefix;
+  A        _total;
+};
+template <typename A, bool ON> A * RA_PrefixState<A, ON>::_prefix = NULL;
+template <typename A, bool ON> A   RA_PrefixState<A, ON>::_total = 0;
+
+
+template <typename T, bool ON>
+struct RA_RangeState
+{
+  static T * _tree;
+};
+template <typename T>
+struct RA_RangeState<T, true>
+{
+  T *      _tree;
+};
+template <typename T, bool ON> T * RA_RangeState<T, ON>::_tree = NULL;
+
+
+template <typename A, bool ON>
+struct RA_QuotientState
+{
+  static A        _quotient;
+  static uint16_t _remainder;
+};
+template <typename A>
+struct RA_QuotientState<A, true>
+{
+  A        _quotient;
+  uint16_t _remainder;
+};
+template <typename A, bool ON> A        RA_QuotientState<A, ON>::_quotient = 0;
+template <typename A, bool ON> uint16_t RA_QuotientState<A, ON>::_remainder = 0;
+
+
+template <typename A, bool ON>
+struct RA_WeightedState
+{
+  static A _weighted;
+};
+template <typename A>
+struct RA_WeightedState<A, true>
+{
+  A        _weighted;
+};
+template <typename A, bool ON> A RA_WeightedState<A, ON>::_weighted = 0;
+
+
+template <typename A, bool ON>
+struct RA_LookbackState
+{
+  static uint16_t _lookLength[RA_LOOKBACKS];
+  static A        _lookSum[RA_LOOKBACKS];
+  static uint8_t  _lookbacks;
+};
+template <typename A>
+struct RA_LookbackState<A, true>
+{
+  uint16_t _lookLength[RA_LOOKBACKS];
+  A        _lookSum[RA_LOOKBACKS];
+  uint8_t  _lookbacks;
+};
+template <typename A, bool ON> uint16_t RA_LookbackState<A, ON>::_lookLength[RA_LOOKBACKS];
+template <typename A, bool ON> A        RA_LookbackState<A, ON>::_lookSum[RA_LOOKBACKS];
+template <typename A, bool ON> uint8_t  RA_LookbackState<A, ON>::_lookbacks = 0;
+
+
+template <bool ON>
+struct RA_HistogramState
+{
+  static uint16_t * _histogram;
+};
+template <>
+struct RA_HistogramState<true>
+{
+  uint16_t * _histogram;
+};
+template <bool ON> uint16_t * RA_HistogramState<ON>::_histogram = NULL;
+
+
+template <typename T = uint16_t, typename A = uint32_t, uint16_t F = 0>
 class RunningAverage
+: protected RA_MomentsState<((F & RA_MOMENTS4) ? 3 : 1), (F & (RA_MOMENTS | RA_MOMENTS4)) != 0>,
+  protected RA_MinMaxState<(F & RA_MINMAX) != 0>,
+  protected RA_PrefixState<A, (F & RA_PREFIX) != 0>,
+  protected RA_RangeState<T, (F & RA_RANGE) != 0>,
+  protected RA_QuotientState<A, (F & RA_QUOTIENT) != 0>,
+  protected RA_WeightedState<A, (F & RA_WEIGHTED) != 0>,
+  protected RA_LookbackState<A, (F & RA_LOOKBACK) != 0>,
+  protected RA_HistogramState<(F & RA_HISTOGRAM) != 0>
 {
 public:
+  static_assert(!(F & RA_HISTOGRAM) || (sizeof(T) <= 2), "RA_HISTOGRAM needs an 8 or 16 bit sample type");
+
   explicit RunningAverage(const uint16_t size);
+  //  caller owned buffer of size elements, e.g. static or pool memory.
+  //  the buffers of the options are still allocated.
+  RunningAverage(const uint16_t size, T * buffer);
+  //  all buffers from the allocator hooks.
+  RunningAverage(const uint16_t size, const RA_Allocator & allocator);
+  //  caller owned buffer, the buffers of the options from the allocator hooks.
+  RunningAverage(const uint16_t size, T * buffer, const RA_Allocator & allocator);
+  //  frees only what the object allocated.
   ~RunningAverage();
 
+  //  deep copy, the copy allocates its own buffers (also for a caller buffer),
+  //  with the allocator hooks of other. Size 0 if that fails.
+  RunningAverage(const RunningAverage & other);
+  RunningAverage & operator = (const RunningAverage & other);
+  //  move takes the buffers, other becomes an empty size 0 object.
+  RunningAverage(RunningAverage && other) noexcept;
+  RunningAverage & operator = (RunningAverage && other) noexcept;
+  void     swap(RunningAverage & other) noexcept;
+
   void     clear();
-  void     add(const uint16_t value)    { addValue(value); };
-  void     addValue(const uint16_t value);
-  void     fillValue(const uint16_t value, const uint16_t number);
-  uint16_t    getValue(const uint16_t position);
+  void     add(const T value)    { addValue(value); };
+  void     addValue(const T value);
+  //  adds a block of values, e.g. from DMA, in at most two memcpy's.
+  //  with compile time options it adds them one by one.
+  void     addValues(const T * values, size_t number);
+  void     fillValue(const T value, const uint16_t number);
+  T        getValue(const uint16_t position) const;
 
-  uint16_t    getAverage();            //  iterates over all elements.
-  uint16_t    getFastAverage() const;  //  reuses previous calculated values.
+  T        getAverage() const;      //  iterates over all elements.
+  T        getFastAverage() const;  //  reuses previous calculated values.
+                                    //  no division with RA_QUOTIENT.
+  void     setRounding(uint8_t mode = RA_ROUND_FLOOR) { _rounding = mode; };
+  uint8_t  getRounding() const { return _rounding; };
 
   //  return statistical characteristics of the running average
-  uint16_t    getStandardDeviation() const;
-  uint16_t    getStandardError() const;
+  //  O(1) with RA_MOMENTS, otherwise iterates over all elements.
+  float    getVariance() const;
+  float    getStandardDeviation() const;
+  float    getStandardError() const;
+  float    getRMS() const;
+  //  O(1) with RA_MOMENTS4, otherwise iterates over all elements.
+  //  RA_MOMENTS4 returns NAN if count * (max - min)^4 >= 2^64, see readme.
+  float    getSkewness() const;
+  float    getKurtosis() const;    //  excess kurtosis, normal distribution = 0
 
   //  returns min/max added to the data-set since last clear
-  uint16_t    getMin() const { return _min; };
-  uint16_t    getMax() const { return _max; };
+  T        getMin() const { return _min; };
+  T        getMax() const { return _max; };
 
   //  returns min/max from the values in the internal buffer
-  uint16_t    getMinInBuffer() const;
-  uint16_t    getMaxInBuffer() const;
+  //  O(1) with RA_MINMAX, O(log N) with RA_RANGE, otherwise iterates over all elements.
+  T        getMinInBuffer() const;
+  T        getMaxInBuffer() const;
 
   //  return true if buffer is full
-  bool     bufferIsFull() const { return _count == _size; };
+  bool     bufferIsFull() const { return _count == _partial; };
 
-  uint16_t    getElement(uint16_t index) const;
+  T        getElement(uint16_t index) const;
 
   uint16_t getSize() const { return _size; }
   uint16_t getCount() const { return _count; }
+  A        getSum() const { return _sum; }
 
   //  use not all elements just a part from 0..partial-1
-  //  (re)setting partial will clear the internal buffer.
+  //  (re)setting partial keeps the newest min(partial, count) values.
   void     setPartial(const uint16_t partial = 0);  // 0 ==> use all
-  uint16_t getPartial()   { return _partial; };
+  uint16_t getPartial() const { return _partial; };
+  //  changes size, also partial, keeps the newest min(size, count) values.
+  //  reallocates only when growing, returns false if that fails (no change).
+  bool     resize(const uint16_t size);
+
+  //  versioned little endian blob for a warm restart:
+  //  header, size, partial, count, index, sum, min, max and the ring of size slots.
+  //  the length is a multiple of 8 so blobs can be stored back to back.
+  size_t   serializedSize() const { return _serialSize(_size); };
+  //  returns the bytes written, 0 if length is too small.
+  size_t   serialize(uint8_t * blob, size_t length) const;
+  //  copies the samples, resizes if needed, rebuilds the options, O(size).
+  //  also restores a size 0 (e.g. moved from) object.
+  //  false if the blob is invalid: the object is unchanged if the header is
+  //  invalid, cleared if the resize fails or the samples do not match the sum.
+  bool     deserialize(const uint8_t * blob, size_t length);
+  //  uses the ring inside blob as caller buffer, no copy of the samples,
+  //  e.g. a mmap'd file. O(1) without options, otherwise the options are rebuilt.
+  //  needs a little endian host and a ring aligned for T, blob must stay valid
+  //  and writable while attached. false if not possible, the object is unchanged.
+  //  attach() does not change the blob, addValue() c.s. write the samples into
+  //  the ring but not the header, serialize() again to store the state.
+  bool     attach(uint8_t * blob, size_t length);
 
 
   //  get some stats from the last count additions.
-  uint16_t    getAverageLast(uint16_t count);
-  uint16_t    getMinInBufferLast(uint16_t count);
-  uint16_t    getMaxInBufferLast(uint16_t count);
+  //  getAverageLast() is O(1) with RA_PREFIX.
+  //  getMin/MaxInBufferLast() are O(log N) with RA_RANGE.
+  T        getAverageLast(uint16_t count) const;
+  T        getMinInBufferLast(uint16_t count) const;
+  T        getMaxInBufferLast(uint16_t count) const;
+
+  //  RA_LOOKBACK, register a length for getAverageLast(), e.g. 10, 60, 300.
+  //  returns false if RA_LOOKBACKS are registered, length is 0 or no RA_LOOKBACK.
+  //  O(length) once, then O(1) per addValue() and getAverageLast(length).
+  bool     addLookback(uint16_t length);
+  void     clearLookbacks()  { if (F & RA_LOOKBACK) _lookbacks = 0; };
+  uint8_t  getLookbacks() const { return (F & RA_LOOKBACK) ? _lookbacks : 0; };
 
   //       Experimental 0.4.3
-  float    getAverageSubset(uint16_t start, uint16_t count);
+  //  start = 0 is the oldest element, O(1) with RA_PREFIX.
+  float    getAverageSubset(uint16_t start, uint16_t count) const;
+  //  O(log N) with RA_RANGE.
+  T        getMinInBufferSubset(uint16_t start, uint16_t count) const;
+  T        getMaxInBufferSubset(uint16_t start, uint16_t count) const;
+
+  //  linearly weighted, newest weight count, oldest weight 1.
+  //  O(1) with RA_WEIGHTED, otherwise iterates over all elements.
+  T        getWeightedAverage() const;
+  A        getWeightedSum() const;
+
+  //  RA_HISTOGRAM only, otherwise 0.
+  //  rank 0 is the smallest value in the buffer, at most 512 bins are scanned.
+  T        getElementByRank(uint16_t rank) const;
+  //  nearest rank, q = 0.0 .. 1.0
+  T        getQuantile(float q) const;
+  //  average of the two middle values if count is even.
+  T        getMedian() const;
 
 
 protected:
+  //  largest first, less padding on 32 and 64 bit hosts.
+  T *      _array;
+  RA_Allocator _allocator;
+  A        _sum;
   uint16_t _size;
+  uint16_t _capacity;   //  elements allocated, >= _size after a shrinking resize()
   uint16_t _count;
   uint16_t _index;
   uint16_t _partial;
-  uint16_t    _sum;
-  uint16_t*   _array;
-  uint16_t    _min;
-  uint16_t    _max;
+  //  lazy fillValue(), slots [_fillLow, _fillEnd) hold _fillValue until
+  //  addValue() overwrites them, which it does in order from _fillLow.
+  uint16_t _fillLow;
+  uint16_t _fillEnd;
+  T        _fillValue;
+  T        _min;
+  T        _max;
+  bool     _ownsArray;
+  uint8_t  _rounding;
+
+  //  the option state, only stored for the options in F, see RA_MomentsState c.s.
+  //  RA_MOMENTS, exact running sums of x^2 (and x^3, x^4 for RA_MOMENTS4).
+  //  unsigned so add + subtract is exact modulo 2^64, see readme.
+  static const uint8_t _MOMENTS = (F & RA_MOMENTS4) ? 3 : 1;
+  using RA_MomentsState<_MOMENTS, (F & (RA_MOMENTS | RA_MOMENTS4)) != 0>::_moment;
+
+  //  RA_MINMAX, indices of ascending minima and descending maxima.
+  using RA_MinMaxState<(F & RA_MINMAX) != 0>::_deques;
+  using RA_MinMaxState<(F & RA_MINMAX) != 0>::_minDeque;
+  using RA_MinMaxState<(F & RA_MINMAX) != 0>::_maxDeque;
+
+  //  RA_PREFIX, _prefix[i] = _total before _array[i] was added.
+  //  wraps around like _sum, differences of two entries are exact.
+  using RA_PrefixState<A, (F & RA_PREFIX) != 0>::_prefix;
+  using RA_PrefixState<A, (F & RA_PREFIX) != 0>::_total;
+
+  //  RA_RANGE, two segment trees over the slots of _array.
+  //  min tree in _tree[0 .. 2*size), max tree in _tree[2*size .. 4*size).
+  //  leaves at [size .. 2*size), parent i of 2i and 2i+1.
+  using RA_RangeState<T, (F & RA_RANGE) != 0>::_tree;
+
+  //  RA_QUOTIENT, _sum == _quotient * _count + _remainder
+  //  0 <= _remainder < _count
+  using RA_QuotientState<A, (F & RA_QUOTIENT) != 0>::_quotient;
+  using RA_QuotientState<A, (F & RA_QUOTIENT) != 0>::_remainder;
+
+  //  RA_WEIGHTED, sum of value * weight, weight 1 (oldest) .. count (newest).
+  //  A must hold max(T) * size * (size + 1) / 2.
+  using RA_WeightedState<A, (F & RA_WEIGHTED) != 0>::_weighted;
+
+  //  RA_LOOKBACK, running sum of the last min(length, partial) values.
+  using RA_LookbackState<A, (F & RA_LOOKBACK) != 0>::_lookLength;
+  using RA_LookbackState<A, (F & RA_LOOKBACK) != 0>::_lookSum;
+  using RA_LookbackState<A, (F & RA_LOOKBACK) != 0>::_lookbacks;
+
+  //  RA_HISTOGRAM, 65536 fine bins followed by 256 coarse bins,
+  //  coarse bin c is the sum of fine bins [256c .. 256c + 256).
+  using RA_HistogramState<(F & RA_HISTOGRAM) != 0>::_histogram;
+  static const uint32_t _HISTOGRAM_BINS = 65536UL + 256;
+  void     _histogramAdd(const T value, const uint16_t number)
+  {
+    _histogram[value] += number;
+    _histogram[65536UL + (value >> 8)] += number;
+  };
+  void     _histogramRemove(const T value)
+  {
+    _histogram[value]--;
+    _histogram[65536UL + (value >> 8)]--;
+  };
+
+  T        _at(uint16_t idx) const
+  {
+    return ((idx >= _fillLow) && (idx < _fillEnd)) ? _fillValue : _array[idx];
+  };
+  A        _prefixAt(uint16_t idx) const
+  {
+    return ((idx >= _fillLow) && (idx < _fillEnd)) ? (A)_fillValue * idx : _prefix[idx];
+  };
+
+  void     _begin(const uint16_t size, T * buffer);
+
+  //  serialize() header, the ring starts 8 byte aligned.
+  static const uint8_t _SERIAL_HEADER = 14;
+  struct _Serial
+  {
+    uint16_t size;
+    uint16_t partial;
+    uint16_t count;
+    uint16_t index;
+    A        sum;
+    T        minimum;
+    T        maximum;
+  };
+  static size_t _ringOffset()
+  {
+    return (_SERIAL_HEADER + sizeof(A) + 2 * sizeof(T) + 7) & ~(size_t)7;
+  };
+  static size_t _serialSize(const uint16_t size)
+  {
+    return (_ringOffset() + (size_t)size * sizeof(T) + 7) & ~(size_t)7;
+  };
+  static bool _parse(const uint8_t * blob, size_t length, _Serial & header);
+  static void _putLE(uint8_t * p, uint64_t value, uint8_t bytes)
+  {
+    for (uint8_t b = 0; b < bytes; b++) { p[b] = value & 0xFF; value >>= 8; }
+  };
+  static uint64_t _getLE(const uint8_t * p, uint8_t bytes)
+  {
+    uint64_t value = 0;
+    for (uint8_t b = bytes; b > 0; b--) value = (value << 8) | p[b - 1];
+    return value;
+  };
+  void     _rebuild();
+  void     _none();
+  template <typename V>
+  static void _exchange(V & a, V & b) { V t = a; a = b; b = t; };
+  void     _release();
+  void     _nullOptions();
+  void *   _allocate(size_t bytes) const
+  {
+    if (_allocator.allocate != NULL) return _allocator.allocate(bytes, _allocator.context);
+    return malloc(bytes);
+  };
+  void     _deallocate(void * p, size_t bytes) const
+  {
+    if (p == NULL) return;
+    if (_allocator.deallocate != NULL) _allocator.deallocate(p, bytes, _allocator.context);
+    else free(p);
+  };
+  //  zeroed, NULL if it does not fit a 16 bit size_t (AVR).
+  uint16_t * _allocateHistogram() const
+  {
+    uint32_t bins = _HISTOGRAM_BINS;
+    if ((size_t)(bins * sizeof(uint16_t)) != bins * sizeof(uint16_t)) return NULL;
+    uint16_t * histogram = (uint16_t*) _allocate(bins * sizeof(uint16_t));
+    if (histogram != NULL) memset(histogram, 0, bins * sizeof(uint16_t));
+    return histogram;
+  };
+  uint16_t _slot(uint16_t position) const;
+  A        _rangeSum(uint16_t position, uint16_t count) const;
+  T        _rangeMinMax(uint16_t position, uint16_t count, bool maximum) const;
+  A        _slotSum(uint16_t first, uint16_t last) const;
+  uint64_t _slotSumSquares(uint16_t first, uint16_t last) const;
+  T        _slotMinMax(uint16_t first, uint16_t last, bool maximum) const;
+  void     _copyBlock(const T * values, uint16_t first, uint16_t number, bool evict);
+  void     _materialize();
+  void     _keepNewest(const uint16_t size, const uint16_t partial);
+  void     _treeSet(uint16_t idx, const T value);
+  void     _treeBuild();
+  T        _round(A quotient, uint16_t remainder) const;
+  //  RA_QUOTIENT, same count, shift the remainder by the delta and carry
+  //  whole multiples of _count into the quotient.
+  //  only divides if the remainder leaves [0, _count).
+  template <typename S>
+  void     _shiftRemainder(const T value, const T prev)
+  {
+    S rem = (S)_remainder + ((S)value - (S)prev);
+    S cnt = _count;
+    if ((rem < 0) || (rem >= cnt))
+    {
+      S carry = (rem >= 0) ? rem / cnt : -((cnt - 1 - rem) / cnt);
+      _quotient += carry;
+      rem -= carry * cnt;
+    }
+    _remainder = rem;
+  };
+  bool     _centralMoments(float & m2, float & m3, float * m4) const;
 };
 
 
+///////////////////////////////////////////////////////////////
+//
+//  IMPLEMENTATION
+//
+template <typename T, typename A, uint16_t F>
+RunningAverage<T, A, F>::RunningAverage(const uint16_t size)
+: _allocator()
+{
+  _begin(size, NULL);
+}
+
+
+template <typename T, typename A, uint16_t F>
+RunningAverage<T, A, F>::RunningAverage(const uint16_t size, T * buffer)
+: _allocator()
+{
+  _begin(size, buffer);
+}
+
+
+template <typename T, typename A, uint16_t F>
+RunningAverage<T, A, F>::RunningAverage(const uint16_t size, const RA_Allocator & allocator)
+: _allocator(allocator)
+{
+  _begin(size, NULL);
+}
+
+
+template <typename T, typename A, uint16_t F>
+RunningAverage<T, A, F>::RunningAverage(const uint16_t size, T * buffer, const RA_Allocator & allocator)
+: _allocator(allocator)
+{
+  _begin(size, buffer);
+}
+
+
+template <typename T, typename A, uint16_t F>
+RunningAverage<T, A, F>::RunningAverage(const RunningAverage & other)
+: _allocator(other._allocator)
+{
+  if (other._array == NULL)
+  {
+    _none();
+    return;
+  }
+  _begin(other._size, NULL);
+  if (_array == NULL) return;
+
+  //  the slots beyond _partial are never read, copy them anyway, it is simpler.
+  //  memmove for the options, the compiler sees the shared static names of
+  //  a disabled option as overlapping arguments.
+  memcpy(_array, other._array, (size_t)_size * sizeof(T));
+  if (F & RA_MINMAX) memmove(_deques, other._deques, (size_t)2 * _size * sizeof(uint16_t));
+  if (F & RA_PREFIX) memmove(_prefix, other._prefix, (size_t)_size * sizeof(A));
+  if (F & RA_RANGE)  memmove(_tree,   other._tree,   (size_t)4 * _size * sizeof(T));
+  if (F & RA_HISTOGRAM) memmove(_histogram, other._histogram, (size_t)_HISTOGRAM_BINS * sizeof(uint16_t));
+
+  _partial  = other._partial;
+  _count    = other._count;
+  _index    = other._index;
+  _sum      = other._sum;
+  _min      = other._min;
+  _max      = other._max;
+  _rounding  = other._rounding;
+  if (F & (RA_MOMENTS | RA_MOMENTS4))
+  {
+    for (uint8_t m = 0; m < _MOMENTS; m++) _moment[m] = other._moment[m];
+  }
+  if (F & RA_MINMAX)
+  {
+    _minDeque = other._minDeque;
+    _maxDeque = other._maxDeque;
+    _minDeque.setBuffer(_deques);
+    _maxDeque.setBuffer(_deques + _size);
+  }
+  if (F & RA_PREFIX) _total = other._total;
+  if (F & RA_QUOTIENT)
+  {
+    _quotient  = other._quotient;
+    _remainder = other._remainder;
+  }
+  if (F & RA_WEIGHTED) _weighted = other._weighted;
+  if (F & RA_LOOKBACK)
+  {
+    for (uint8_t k = 0; k < RA_LOOKBACKS; k++)
+    {
+      _lookLength[k] = other._lookLength[k];
+      _lookSum[k]    = other._lookSum[k];
+    }
+    _lookbacks = other._lookbacks;
+  }
+  _fillLow   = other._fillLow;
+  _fillEnd   = other._fillEnd;
+  _fillValue = other._fillValue;
+}
+
+
+//  copy and swap, the old buffers are freed by the temporary.
+template <typename T, typename A, uint16_t F>
+RunningAverage<T, A, F> & RunningAverage<T, A, F>::operator = (const RunningAverage & other)
+{
+  if (this != &other)
+  {
+    RunningAverage copy(other);
+    swap(copy);
+  }
+  return *this;
+}
+
+
+template <typename T, typename A, uint16_t F>
+RunningAverage<T, A, F>::RunningAverage(RunningAverage && other) noexcept
+: _allocator()
+{
+  _none();
+  swap(other);
+}
+
+
+template <typename T, typename A, uint16_t F>
+RunningAverage<T, A, F> & RunningAverage<T, A, F>::operator = (RunningAverage && other) noexcept
+{
+  if (this != &other)
+  {
+    RunningAverage moved(static_cast<RunningAverage &&>(other));
+    swap(moved);
+  }
+  return *this;
+}
+
+
+//  O(1), exchanges the buffers, no copy of the samples.
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::swap(RunningAverage & other) noexcept
+{
+  _exchange(_size, other._size);
+  _exchange(_capacity, other._capacity);
+  _exchange(_ownsArray, other._ownsArray);
+  _exchange(_allocator, other._allocator);
+  _exchange(_count, other._count);
+  _exchange(_index, other._index);
+  _exchange(_partial, other._partial);
+  _exchange(_sum, other._sum);
+  _exchange(_array, other._array);
+  _exchange(_min, other._min);
+  _exchange(_max, other._max);
+  _exchange(_rounding, other._rounding);
+  _exchange(_fillLow, other._fillLow);
+  _exchange(_fillEnd, other._fillEnd);
+  _exchange(_fillValue, other._fillValue);
+  if (F & (RA_MOMENTS | RA_MOMENTS4))
+  {
+    for (uint8_t m = 0; m < _MOMENTS; m++) _exchange(_moment[m], other._moment[m]);
+  }
+  if (F & RA_MINMAX)
+  {
+    //  the deques point into _deques, so they move along.
+    _exchange(_deques, other._deques);
+    _exchange(_minDeque, other._minDeque);
+    _exchange(_maxDeque, other._maxDeque);
+  }
+  if (F & RA_PREFIX)
+  {
+    _exchange(_prefix, other._prefix);
+    _exchange(_total, other._total);
+  }
+  if (F & RA_RANGE) _exchange(_tree, other._tree);
+  if (F & RA_QUOTIENT)
+  {
+    _exchange(_quotient, other._quotient);
+    _exchange(_remainder, other._remainder);
+  }
+  if (F & RA_WEIGHTED) _exchange(_weighted, other._weighted);
+  if (F & RA_LOOKBACK)
+  {
+    for (uint8_t k = 0; k < RA_LOOKBACKS; k++)
+    {
+      _exchange(_lookLength[k], other._lookLength[k]);
+      _exchange(_lookSum[k], other._lookSum[k]);
+    }
+    _exchange(_lookbacks, other._lookbacks);
+  }
+  if (F & RA_HISTOGRAM) _exchange(_histogram, other._histogram);
+}
+
+
+//  empty size 0 object without allocations.
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::_none()
+{
+  _size = _capacity = _partial = 0;
+  _ownsArray = true;
+  _array  = NULL;
+  _nullOptions();
+  _count = 0;
+  _fillLow = 0;
+  _fillEnd = 0;
+  _rounding = RA_ROUND_FLOOR;
+  if (F & RA_LOOKBACK) _lookbacks = 0;
+  if (F & RA_MINMAX)
+  {
+    _minDeque.begin(NULL, 0);
+    _maxDeque.begin(NULL, 0);
+  }
+  clear();
+}
+
+
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::_begin(const uint16_t size, T * buffer)
+{
+  //  size 0, also a zero length caller buffer, is an object without buffers.
+  //  malloc(0) may return a pointer that must not be used.
+  if (size == 0)
+  {
+    _none();
+    return;
+  }
+  _size = size;
+  _capacity = size;
+  _partial = _size;
+  _ownsArray = (buffer == NULL);
+  _array  = _ownsArray ? (T*) _allocate((size_t)_size * sizeof(T)) : buffer;
+  _nullOptions();
+  _count = 0;
+  _fillLow = 0;
+  _fillEnd = 0;
+  _rounding = RA_ROUND_FLOOR;
+  if (F & RA_LOOKBACK) _lookbacks = 0;
+  if (F & RA_MINMAX) _deques = (uint16_t*) _allocate((size_t)2 * _size * sizeof(uint16_t));
+  if (F & RA_PREFIX) _prefix = (A*) _allocate((size_t)_size * sizeof(A));
+  if (F & RA_RANGE)  _tree   = (T*) _allocate((size_t)4 * _size * sizeof(T));
+  if (F & RA_HISTOGRAM) _histogram = _allocateHistogram();
+
+  //  all or nothing
+  if ((_array == NULL) ||
+     ((F & RA_MINMAX) && (_deques == NULL)) ||
+     ((F & RA_PREFIX) && (_prefix == NULL)) ||
+     ((F & RA_RANGE)  && (_tree   == NULL)) ||
+     ((F & RA_HISTOGRAM) && (_histogram == NULL)))
+  {
+    _release();
+    _size = _capacity = _partial = 0;
+  }
+  if (F & RA_MINMAX)
+  {
+    _minDeque.begin(_deques, _size);
+    _maxDeque.begin(_deques + _size, _size);
+  }
+  clear();
+}
+
+
+template <typename T, typename A, uint16_t F>
+RunningAverage<T, A, F>::~RunningAverage()
+{
+  _release();
+}
+
+
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::_release()
+{
+  if (_ownsArray) _deallocate(_array, (size_t)_capacity * sizeof(T));
+  if (F & RA_MINMAX) _deallocate(_deques, (size_t)2 * _capacity * sizeof(uint16_t));
+  if (F & RA_PREFIX) _deallocate(_prefix, (size_t)_capacity * sizeof(A));
+  if (F & RA_RANGE)  _deallocate(_tree,   (size_t)4 * _capacity * sizeof(T));
+  if (F & RA_HISTOGRAM) _deallocate(_histogram, (size_t)_HISTOGRAM_BINS * sizeof(uint16_t));
+  _array  = NULL;
+  _nullOptions();
+}
+
+
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::_nullOptions()
+{
+  if (F & RA_MINMAX) _deques = NULL;
+  if (F & RA_PREFIX) _prefix = NULL;
+  if (F & RA_RANGE)  _tree   = NULL;
+  if (F & RA_HISTOGRAM) _histogram = NULL;
+}
+
+
+//  resets all counters, O(1).
+//  the buffer is not zeroed, only slots < _count are ever read.
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::clear()
+{
+  if ((F & RA_HISTOGRAM) && (_histogram != NULL))
+  {
+    //  O(count), only the values in the buffer are in the histogram.
+    for (uint16_t i = 0; i < _count; i++) _histogramRemove(_at(i));
+  }
+  _count = 0;
+  _index = 0;
+  _sum = 0;
+  _min = 0;
+  _max = 0;
+  _fillLow = 0;
+  _fillEnd = 0;
+  _fillValue = 0;
+  if (F & RA_MINMAX)
+  {
+    _minDeque.clear();
+    _maxDeque.clear();
+  }
+  if (F & (RA_MOMENTS | RA_MOMENTS4))
+  {
+    for (uint8_t m = 0; m < _MOMENTS; m++) _moment[m] = 0;
+  }
+  if (F & RA_PREFIX) _total = 0;
+  if (F & RA_QUOTIENT)
+  {
+    _quotient = 0;
+    _remainder = 0;
+  }
+  if (F & RA_WEIGHTED) _weighted = 0;
+  if (F & RA_LOOKBACK)
+  {
+    for (uint8_t k = 0; k < _lookbacks; k++) _lookSum[k] = 0;
+  }
+}
+
+
+//  adds a new value to the data-set
+//  the accumulator is unsigned so subtract + add is exact, no drift.
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::addValue(const T value)
+{
+  if (_array == NULL)
+  {
+    return;
+  }
+
+  //  the slot at _index leaves the window when the buffer is full.
+  bool full = (_count == _partial);
+  T    prev = full ? _at(_index) : 0;
+
+  if (F & RA_MINMAX)
+  {
+    if (full)
+    {
+      if (_minDeque.front() == _index) _minDeque.popFront();
+      if (_maxDeque.front() == _index) _maxDeque.popFront();
+    }
+    while (!_minDeque.empty() && (_at(_minDeque.back()) >= value)) _minDeque.popBack();
+    while (!_maxDeque.empty() && (_at(_maxDeque.back()) <= value)) _maxDeque.popBack();
+    _minDeque.pushBack(_index);
+    _maxDeque.pushBack(_index);
+  }
+
+  if (F & (RA_MOMENTS | RA_MOMENTS4))
+  {
+    uint64_t prev1 = prev;
+    uint64_t next  = value;
+    uint64_t prev2 = prev1 * prev1;
+    uint64_t next2 = next * next;
+    _moment[0] += next2 - prev2;
+    if (F & RA_MOMENTS4)
+    {
+      _moment[1] += next2 * next - prev2 * prev1;
+      _moment[2] += next2 * next2 - prev2 * prev2;
+    }
+  }
+
+  if (F & RA_PREFIX)
+  {
+    _prefix[_index] = _total;
+    _total += value;
+  }
+
+  if (F & RA_RANGE) _treeSet(_index, value);
+
+  if (F & RA_HISTOGRAM)
+  {
+    if (full) _histogramRemove(prev);
+    _histogramAdd(value, 1);
+  }
+
+  if (F & RA_WEIGHTED)
+  {
+    //  full: all weights drop by one, the oldest to 0, so subtract the
+    //  sum before the update. filling: weights stay, new weight count + 1.
+    if (full) _weighted += (A)value * _count - _sum;
+    else      _weighted += (A)value * (_count + 1);
+  }
+
+  if (F & RA_LOOKBACK)
+  {
+    //  the value length positions back leaves that sub-window.
+    for (uint8_t k = 0; k < _lookbacks; k++)
+    {
+      uint16_t len = (_lookLength[k] < _partial) ? _lookLength[k] : _partial;
+      if (_count >= len)
+      {
+        uint16_t idx = (_index >= len) ? _index - len : _index + _partial - len;
+        _lookSum[k] -= _at(idx);
+      }
+      _lookSum[k] += value;
+    }
+  }
+
+  _sum -= prev;
+  _array[_index] = value;
+  _sum += value;
+  //  a lazy filled slot is overwritten.
+  if ((_index == _fillLow) && (_fillLow < _fillEnd)) _fillLow++;
+  _index++;
+
+  if (_index == _partial) _index = 0;  //  faster than %
+
+  //  handle min max
+  if (_count == 0) _min = _max = value;
+  else if (value < _min) _min = value;
+  else if (value > _max) _max = value;
+
+  if (F & RA_QUOTIENT)
+  {
+    if (full)
+    {
+      //  the delta needs a signed type wider than T.
+      if (sizeof(T) <= 2) _shiftRemainder<int32_t>(value, prev);
+      else                _shiftRemainder<int64_t>(value, prev);
+    }
+    else
+    {
+      //  count changes, only while filling the buffer.
+      uint16_t cnt = _count + 1;
+      _quotient  = _sum / cnt;
+      _remainder = _sum - _quotient * cnt;
+    }
+  }
+
+  //  update count as last otherwise if ( _count == 0) above will fail
+  if (_count < _partial) _count++;
+}
+
+
+//  adds number values in one go.
+//  the new values overwrite at most two runs of slots, so the sum is
+//  updated with the sum of the incoming minus the outgoing values.
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::addValues(const T * values, size_t number)
+{
+  if ((_array == NULL) || (values == NULL) || (number == 0))
+  {
+    return;
+  }
+
+  if (F != 0)
+  {
+    //  options need every single eviction.
+    for (size_t i = 0; i < number; i++)
+    {
+      addValue(values[i]);
+    }
+    return;
+  }
+
+  _materialize();
+
+  //  handle min max, over all values, they were all added.
+  T lo = (_count == 0) ? values[0] : _min;
+  T hi = (_count == 0) ? values[0] : _max;
+  for (size_t i = 0; i < number; i++)
+  {
+    lo = (values[i] < lo) ? values[i] : lo;
+    hi = (values[i] > hi) ? values[i] : hi;
+  }
+  _min = lo;
+  _max = hi;
+
+  //  only the last _partial values end up in the buffer.
+  if (number >= _partial)
+  {
+    _sum = 0;
+    _index = 0;
+    _copyBlock(values + (number - _partial), 0, _partial, false);
+    _count = _partial;
+    return;
+  }
+
+  //  if not full, _index == _count and the first run goes into empty slots,
+  //  the second run always overwrites the oldest values.
+  uint16_t n = number;
+  uint16_t first = _partial - _index;
+  if (first > n) first = n;
+  _copyBlock(values, _index, first, _count == _partial);
+  _copyBlock(values + first, 0, n - first, true);
+
+  _index += n;
+  if (_index >= _partial) _index -= _partial;
+  if (_partial - _count < n) _count = _partial;
+  else _count += n;
+}
+
+
+//  copies number values into _array[first ..] and updates _sum.
+//  evict == false means the slots are empty.
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::_copyBlock(const T * values, uint16_t first, uint16_t number, bool evict)
+{
+  if (number == 0) return;
+  T * dest = _array + first;
+  A incoming = ra_sum(values, number);
+  A outgoing = evict ? (A)ra_sum(dest, number) : 0;
+  memcpy(dest, values, number * sizeof(T));
+  _sum += incoming - outgoing;
+}
+
+
+//  writes the lazy filled slots, O(number of lazy slots).
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::_materialize()
+{
+  for (uint16_t i = _fillLow; i < _fillEnd; i++)
+  {
+    _array[i] = _fillValue;
+    if (F & RA_PREFIX) _prefix[i] = (A)_fillValue * i;
+  }
+  _fillLow = 0;
+  _fillEnd = 0;
+}
+
+
+//  returns the average of the data-set added so far, 0 if no elements.
+//  the integer running sum is exact, so there is no need to write it back,
+//  which makes concurrent reads safe.
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getAverage() const
+{
+  if (_count == 0)
+  {
+    return 0;
+  }
+  A sum = _slotSum(0, _count);
+  return sum / _count;   //  multiplication is faster ==> extra admin
+}
+
+
+//  the larger the size of the internal buffer
+//  the greater the gain wrt getAverage()
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getFastAverage() const
+{
+  if (_count == 0)
+  {
+    return 0;
+  }
+  if (F & RA_QUOTIENT) return _round(_quotient, _remainder);
+
+  A quotient = _sum / _count;   //  multiplication is faster ==> extra admin
+  if (_rounding == RA_ROUND_FLOOR) return quotient;
+  return _round(quotient, _sum - quotient * _count);
+}
+
+
+//  round quotient + remainder / _count, no division.
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::_round(A quotient, uint16_t remainder) const
+{
+  if (_rounding == RA_ROUND_FLOOR) return quotient;
+
+  uint32_t twice = 2UL * remainder;
+  if (twice > _count) return quotient + 1;
+  if (twice < _count) return quotient;
+  //  exactly half
+  if (_rounding == RA_ROUND_NEAREST) return quotient + 1;
+  return quotient + (quotient & 1);   //  banker: to even
+}
+
+
+//  returns the minimum value in the buffer
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getMinInBuffer() const
+{
+  if (_count == 0)
+  {
+    return 0;
+  }
+  if (F & RA_MINMAX) return _at(_minDeque.front());
+
+  return _slotMinMax(0, _count, false);
+}
+
+
+//  returns the maximum value in the buffer
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getMaxInBuffer() const
+{
+  if (_count == 0)
+  {
+    return 0;
+  }
+  if (F & RA_MINMAX) return _at(_maxDeque.front());
+
+  return _slotMinMax(0, _count, true);
+}
+
+
+//  returns the value of an element if exist, 0 otherwise
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getElement(uint16_t index) const
+{
+  if (index >= _count)
+  {
+    return 0;
+  }
+
+  return _at(index);
+}
+
+
+//  Return the (sample) variance of running average.
+//  If buffer is empty or has only one element, return NAN.
+template <typename T, typename A, uint16_t F>
+float RunningAverage<T, A, F>::getVariance() const
+{
+  if (_count <= 1) return NAN;
+
+  if (F & (RA_MOMENTS | RA_MOMENTS4))
+  {
+    //  n * sum(x^2) - sum(x)^2 is exact in 64 bit, even if the terms wrap.
+    uint64_t n = _count;
+    uint64_t s = _sum;
+    uint64_t numerator = n * _moment[0] - s * s;
+    return (float)numerator / ((float)_count * (_count - 1));
+  }
+
+  //  same exact formula, sum of squares by (SIMD) kernel.
+  uint64_t n = _count;
+  uint64_t s = _sum;
+  uint64_t numerator = n * _slotSumSquares(0, _count) - s * s;
+  return (float)numerator / ((float)_count * (_count - 1));
+}
+
+
+//  Return standard deviation of running average.
+//  If buffer is empty or has only one element, return NAN.
+template <typename T, typename A, uint16_t F>
+float RunningAverage<T, A, F>::getStandardDeviation() const
+{
+  //  see issue #13, RA_MOMENTS makes this O(1)
+  return sqrt(getVariance());
+}
+
+
+//  Return standard error of running average.
+//  If buffer is empty or has only one element, return NAN.
+template <typename T, typename A, uint16_t F>
+float RunningAverage<T, A, F>::getStandardError() const
+{
+  float temp = getStandardDeviation();
+  if (isnan(temp)) return NAN;
+
+  float n;
+  if (_count >= 30) n = _count;
+  else n = _count - 1;
+  temp = temp/sqrt(n);
+
+  return temp;
+}
+
+
+//  Return root mean square of running average.
+//  If buffer is empty, return NAN.
+template <typename T, typename A, uint16_t F>
+float RunningAverage<T, A, F>::getRMS() const
+{
+  if (_count == 0) return NAN;
+
+  if (F & (RA_MOMENTS | RA_MOMENTS4))
+  {
+    return sqrt((float)_moment[0] / _count);
+  }
+  return sqrt((float)_slotSumSquares(0, _count) / _count);
+}
+
+
+//  Return skewness (population) of running average.
+//  If buffer has less than 2 elements or all elements are equal, return NAN.
+template <typename T, typename A, uint16_t F>
+float RunningAverage<T, A, F>::getSkewness() const
+{
+  float m2, m3;
+  if (!_centralMoments(m2, m3, NULL)) return NAN;
+  return m3 / (m2 * sqrt(m2));
+}
+
+
+//  Return excess kurtosis (population) of running average.
+//  If buffer has less than 2 elements or all elements are equal, return NAN.
+template <typename T, typename A, uint16_t F>
+float RunningAverage<T, A, F>::getKurtosis() const
+{
+  float m2, m3, m4;
+  if (!_centralMoments(m2, m3, &m4)) return NAN;
+  return m4 / (m2 * m2) - 3;
+}
+
+
+//  2nd, 3rd and optional 4th central moment, divided by n.
+template <typename T, typename A, uint16_t F>
+bool RunningAverage<T, A, F>::_centralMoments(float & m2, float & m3, float * m4) const
+{
+  if (_count <= 1) return false;
+
+  if (F & RA_MOMENTS4)
+  {
+    //  the raw moments cancel a lot for data with a large offset, so first
+    //  shift them to c = floor(mean) in integers: t[k] = sum((x - c)^k).
+    //  modulo 2^64 like the moments, exact only if the shifted sums fit:
+    //  |x - c| <= max - min, so n * (max - min)^4 < 2^64, e.g. 12 bit data.
+    //  min and max since clear(), O(1), include the buffer.
+    double range = (double)_max - (double)_min;
+    if ((double)_count * range * range * range * range >= 18446744073709551616.0) return false;
+
+    uint64_t n  = _count;
+    uint64_t s1 = _sum;
+    uint64_t c  = s1 / n;
+    uint64_t c2 = c * c;
+    uint64_t t1 = s1 - n * c;
+    uint64_t t2 = _moment[0] - 2 * c * s1 + n * c2;
+    int64_t  t3 = (int64_t)(_moment[1] - 3 * c * _moment[0] + 3 * c2 * s1 - n * c2 * c);
+    uint64_t t4 = _moment[2] - 4 * c * _moment[1] + 6 * c2 * _moment[0] - 4 * c2 * c * s1 + n * c2 * c2;
+
+    //  0 <= d < 1, little cancellation left.
+    double dn = n;
+    double d  = t1 / dn;
+    double e2 = t2 / dn;
+    double e3 = t3 / dn;
+    m2 = (n * _moment[0] - s1 * s1) / (dn * dn);     //  exact numerator
+    m3 = e3 - 3 * d * e2 + 2 * d * d * d;
+    if (m4 != NULL)
+    {
+      *m4 = t4 / dn - 4 * d * e3 + 6 * d * d * e2 - 3 * d * d * d * d;
+    }
+  }
+  else
+  {
+    float n = _count;
+    float mean = _sum / n;
+    float s2 = 0, s3 = 0, s4 = 0;
+    for (uint16_t i = 0; i < _count; i++)
+    {
+      float d  = _at(i) - mean;
+      float d2 = d * d;
+      s2 += d2;
+      s3 += d2 * d;
+      s4 += d2 * d2;
+    }
+    m2 = s2 / n;
+    m3 = s3 / n;
+    if (m4 != NULL) *m4 = s4 / n;
+  }
+  return m2 > 0;
+}
+
+
+//  fill the average with the same value number times. (weight)
+//  This is maximized to size times.
+//  no need to fill the internal buffer over 100%
+//  O(1), the slots are filled lazily, except for RA_RANGE which
+//  needs the values in its tree.
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::fillValue(const T value, const uint16_t number)
+{
+  clear();
+  uint16_t s = number;
+  if (s > _partial) s = _partial;
+  if (s == 0) return;
+
+  _count = s;
+  _index = (s == _partial) ? 0 : s;
+  _sum   = (A)value * s;
+  _min   = value;
+  _max   = value;
+  _fillValue = value;
+  _fillLow = 0;
+  _fillEnd = s;
+
+  if (F & RA_MINMAX)
+  {
+    //  equal older values never become min or max before the newest.
+    _minDeque.pushBack(s - 1);
+    _maxDeque.pushBack(s - 1);
+  }
+  if (F & (RA_MOMENTS | RA_MOMENTS4))
+  {
+    uint64_t v = value;
+    _moment[0] = v * v * s;
+    if (F & RA_MOMENTS4)
+    {
+      _moment[1] = v * v * v * s;
+      _moment[2] = v * v * v * v * s;
+    }
+  }
+  if (F & RA_PREFIX) _total = _sum;
+  if (F & RA_WEIGHTED) _weighted = (A)value * ((uint32_t)s * (s + 1) / 2);
+  if (F & RA_LOOKBACK)
+  {
+    for (uint8_t k = 0; k < _lookbacks; k++)
+    {
+      _lookSum[k] = (A)value * ((_lookLength[k] < s) ? _lookLength[k] : s);
+    }
+  }
+  if (F & RA_HISTOGRAM) _histogramAdd(value, s);
+  if (F & RA_QUOTIENT)
+  {
+    _quotient  = value;
+    _remainder = 0;
+  }
+  if (F & RA_RANGE)
+  {
+    _materialize();
+    _treeBuild();
+  }
+}
+
+
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getValue(const uint16_t position) const
+{
+  if (_count == 0)
+  {
+    return 0;
+  }
+  if (position >= _count)
+  {
+    return 0;  // cannot ask more than is added
+  }
+
+  uint16_t _pos = position + _index;
+  if (_pos >= _count) _pos -= _count;
+  return _at(_pos);
+}
+
+
+//  WS / (1 + 2 + .. + count), exact integer division.
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getWeightedAverage() const
+{
+  if (_count == 0) return 0;
+  uint32_t weights = (uint32_t)_count * (_count + 1) / 2;
+  return getWeightedSum() / weights;
+}
+
+
+template <typename T, typename A, uint16_t F>
+A RunningAverage<T, A, F>::getWeightedSum() const
+{
+  if (F & RA_WEIGHTED) return _weighted;
+  A ws = 0;
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    ws += (A)_at(_slot(i)) * (i + 1);
+  }
+  return ws;
+}
+
+
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::setPartial(const uint16_t partial)
+{
+  uint16_t p = partial;
+  if ((p == 0) || (p > _size)) p = _size;
+  _keepNewest(_size, p);
+}
+
+
+template <typename T, typename A, uint16_t F>
+bool RunningAverage<T, A, F>::resize(const uint16_t size)
+{
+  if (size == 0) return false;
+  //  a size 0 object (failed allocation, moved from) has _capacity 0 and grows here.
+  if (size > _capacity)
+  {
+    //  all or nothing, no realloc() as the allocator hooks have none.
+    //  only the samples are copied, the options are rebuilt by _keepNewest().
+    T *        array  = (T*) _allocate((size_t)size * sizeof(T));
+    uint16_t * deques = (F & RA_MINMAX) ? (uint16_t*) _allocate((size_t)2 * size * sizeof(uint16_t)) : NULL;
+    A *        prefix = (F & RA_PREFIX) ? (A*) _allocate((size_t)size * sizeof(A)) : NULL;
+    T *        tree   = (F & RA_RANGE)  ? (T*) _allocate((size_t)4 * size * sizeof(T)) : NULL;
+    bool       needHistogram = (F & RA_HISTOGRAM) && (_histogram == NULL);
+    uint16_t * histogram = needHistogram ? _allocateHistogram() : NULL;
+    if ((array == NULL) ||
+       ((F & RA_MINMAX) && (deques == NULL)) ||
+       ((F & RA_PREFIX) && (prefix == NULL)) ||
+       ((F & RA_RANGE)  && (tree   == NULL)) ||
+       (needHistogram && (histogram == NULL)))
+    {
+      _deallocate(array,  (size_t)size * sizeof(T));
+      _deallocate(deques, (size_t)2 * size * sizeof(uint16_t));
+      _deallocate(prefix, (size_t)size * sizeof(A));
+      _deallocate(tree,   (size_t)4 * size * sizeof(T));
+      _deallocate(histogram, (size_t)_HISTOGRAM_BINS * sizeof(uint16_t));
+      return false;
+    }
+    _materialize();
+    if (_array != NULL) memcpy(array, _array, (size_t)_size * sizeof(T));
+    if (needHistogram) _histogram = histogram;
+
+    if (_ownsArray) _deallocate(_array, (size_t)_capacity * sizeof(T));
+    if (F & RA_MINMAX)
+    {
+      _deallocate(_deques, (size_t)2 * _capacity * sizeof(uint16_t));
+      _deques = deques;
+    }
+    if (F & RA_PREFIX)
+    {
+      _deallocate(_prefix, (size_t)_capacity * sizeof(A));
+      _prefix = prefix;
+    }
+    if (F & RA_RANGE)
+    {
+      _deallocate(_tree, (size_t)4 * _capacity * sizeof(T));
+      _tree = tree;
+    }
+    _array  = array;
+    _capacity  = size;
+    _ownsArray = true;
+  }
+  _keepNewest(size, size);
+  return true;
+}
+
+
+template <typename T, typename A, uint16_t F>
+size_t RunningAverage<T, A, F>::serialize(uint8_t * blob, size_t length) const
+{
+  size_t bytes = serializedSize();
+  if ((blob == NULL) || (length < bytes)) return 0;
+  memset(blob, 0, bytes);
+  uint8_t * p = blob;
+  p[0] = 'R';
+  p[1] = 'A';
+  p[2] = RA_SERIAL_VERSION;
+  p[3] = sizeof(T);
+  p[4] = sizeof(A);
+  _putLE(p + 6,  _size, 2);
+  _putLE(p + 8,  _partial, 2);
+  _putLE(p + 10, _count, 2);
+  _putLE(p + 12, _index, 2);
+  p += _SERIAL_HEADER;
+  _putLE(p, _sum, sizeof(A));
+  p += sizeof(A);
+  _putLE(p, _min, sizeof(T));
+  p += sizeof(T);
+  _putLE(p, _max, sizeof(T));
+
+  //  the raw ring, unused slots stay 0.
+  p = blob + _ringOffset();
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    _putLE(p, _at(i), sizeof(T));
+    p += sizeof(T);
+  }
+  return bytes;
+}
+
+
+template <typename T, typename A, uint16_t F>
+bool RunningAverage<T, A, F>::_parse(const uint8_t * blob, size_t length, _Serial & header)
+{
+  if ((blob == NULL) || (length < _ringOffset())) return false;
+  if ((blob[0] != 'R') || (blob[1] != 'A') || (blob[2] != RA_SERIAL_VERSION)) return false;
+  if ((blob[3] != sizeof(T)) || (blob[4] != sizeof(A))) return false;
+  header.size    = _getLE(blob + 6, 2);
+  header.partial = _getLE(blob + 8, 2);
+  header.count   = _getLE(blob + 10, 2);
+  header.index   = _getLE(blob + 12, 2);
+  const uint8_t * p = blob + _SERIAL_HEADER;
+  header.sum     = _getLE(p, sizeof(A));
+  header.minimum = _getLE(p + sizeof(A), sizeof(T));
+  header.maximum = _getLE(p + sizeof(A) + sizeof(T), sizeof(T));
+
+  if ((header.size == 0) || (length < _serialSize(header.size))) return false;
+  if ((header.partial == 0) || (header.partial > header.size)) return false;
+  if (header.count > header.partial) return false;
+  //  not full: the next slot is count, full: any slot.
+  if ((header.count < header.partial) && (header.index != header.count)) return false;
+  if (header.index >= header.partial) return false;
+  return true;
+}
+
+
+template <typename T, typename A, uint16_t F>
+bool RunningAverage<T, A, F>::deserialize(const uint8_t * blob, size_t length)
+{
+  _Serial header;
+  if (!_parse(blob, length, header)) return false;
+  clear();
+  if (!resize(header.size)) return false;
+
+  const uint8_t * p = blob + _ringOffset();
+  for (uint16_t i = 0; i < header.count; i++)
+  {
+    _array[i] = _getLE(p, sizeof(T));
+    p += sizeof(T);
+  }
+  _partial = header.partial;
+  _count   = header.count;
+  _index   = header.index;
+  _sum     = header.sum;
+  _min     = header.minimum;
+  _max     = header.maximum;
+  if (F != 0) _rebuild();
+
+  //  the sum doubles as checksum of the ring.
+  if ((_count > 0) && (_slotSum(0, _count) != header.sum))
+  {
+    clear();
+    return false;
+  }
+  return true;
+}
+
+
+template <typename T, typename A, uint16_t F>
+bool RunningAverage<T, A, F>::attach(uint8_t * blob, size_t length)
+{
+  _Serial header;
+  if (!ra_littleEndian() || !_parse(blob, length, header)) return false;
+  T * ring = (T *) (blob + _ringOffset());
+  if (((uintptr_t) ring) % alignof(T) != 0) return false;
+
+  //  first the option buffers, so a failure leaves the object unchanged.
+  //  the settings of this object are kept, like deserialize() does.
+  RunningAverage attached(header.size, ring, _allocator);
+  if (attached._size == 0) return false;
+  attached._rounding = _rounding;
+  if (F & RA_LOOKBACK)
+  {
+    for (uint8_t k = 0; k < RA_LOOKBACKS; k++) attached._lookLength[k] = _lookLength[k];
+    attached._lookbacks = _lookbacks;
+  }
+  swap(attached);
+
+  _partial = header.partial;
+  _count   = header.count;
+  _index   = header.index;
+  _sum     = header.sum;
+  _min     = header.minimum;
+  _max     = header.maximum;
+  if (F != 0) _rebuild();
+  return true;
+}
+
+
+//  _array holds _count samples as a ring, the other state does not
+//  know them yet. adds them again in place, oldest first, O(count).
+//  the samples do not move, so an attached blob still matches its header.
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::_rebuild()
+{
+  uint16_t n = _count;
+  uint16_t first = (n > 0) ? _slot(0) : 0;
+  T minimum = _min;
+  T maximum = _max;
+  _count = 0;   //  nothing to remove from the histogram
+  clear();
+  _index = first;
+  for (uint16_t i = 0; i < n; i++) addValue(_array[_index]);
+  _min = minimum;
+  _max = maximum;
+}
+
+
+//  keeps the newest min(partial, count) values, in order, O(count).
+//  they are rotated to slots 0 .. n-1 and added again, which rebuilds
+//  the sum, the deques and all other options in one pass.
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::_keepNewest(const uint16_t size, const uint16_t partial)
+{
+  if (_array == NULL) return;
+  _materialize();
+  uint16_t n = (_count < partial) ? _count : partial;
+  if (_count > 0) ra_rotate(_array, _count, _slot(_count - n));
+
+  T minimum = _min;
+  T maximum = _max;
+  clear();
+  _size = size;
+  _partial = partial;
+  if (F & RA_MINMAX)
+  {
+    _minDeque.begin(_deques, _size);
+    _maxDeque.begin(_deques + _size, _size);
+  }
+  for (uint16_t i = 0; i < n; i++) addValue(_array[i]);
+  if (n > 0)
+  {
+    //  since clear(), not since the resize.
+    _min = minimum;
+    _max = maximum;
+  }
+}
+
+
+//  wraps around _partial, not _size, as only those slots are in use.
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getAverageLast(uint16_t count) const
+{
+  uint16_t cnt = count;
+  if (cnt > _count) cnt = _count;
+  if (cnt == 0) return 0;
+
+  //  a registered length covers the last min(length, count) values.
+  if (F & RA_LOOKBACK)
+  {
+    for (uint8_t k = 0; k < _lookbacks; k++)
+    {
+      if (_lookLength[k] == count) return _lookSum[k] / cnt;
+    }
+  }
+  return _rangeSum(_count - cnt, cnt) / cnt;
+}
+
+
+template <typename T, typename A, uint16_t F>
+bool RunningAverage<T, A, F>::addLookback(uint16_t length)
+{
+  if (!(F & RA_LOOKBACK) || (length == 0) || (_lookbacks >= RA_LOOKBACKS)) return false;
+  uint16_t cnt = (length < _count) ? length : _count;
+  _lookLength[_lookbacks] = length;
+  _lookSum[_lookbacks] = (cnt == 0) ? 0 : _rangeSum(_count - cnt, cnt);
+  _lookbacks++;
+  return true;
+}
+
+
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getMinInBufferLast(uint16_t count) const
+{
+  uint16_t cnt = count;
+  if (cnt > _count) cnt = _count;
+  if (cnt == 0) return 0;
+
+  return _rangeMinMax(_count - cnt, cnt, false);
+}
+
+
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getMaxInBufferLast(uint16_t count) const
+{
+  uint16_t cnt = count;
+  if (cnt > _count) cnt = _count;
+  if (cnt == 0) return 0;
+
+  return _rangeMinMax(_count - cnt, cnt, true);
+}
+
+
+//  the subset is clipped to the elements in the buffer.
+template <typename T, typename A, uint16_t F>
+float RunningAverage<T, A, F>::getAverageSubset(uint16_t start, uint16_t count) const
+{
+  if (start >= _count)
+  {
+    return NAN;
+  }
+
+  uint16_t cnt = _count - start;
+  if (cnt > count) cnt = count;
+  if (cnt == 0) return NAN;
+
+  return (float)_rangeSum(start, cnt) / cnt;
+}
+
+
+//  the subset is clipped to the elements in the buffer, 0 if empty.
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getMinInBufferSubset(uint16_t start, uint16_t count) const
+{
+  if (start >= _count) return 0;
+  uint16_t cnt = _count - start;
+  if (cnt > count) cnt = count;
+  if (cnt == 0) return 0;
+
+  return _rangeMinMax(start, cnt, false);
+}
+
+
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getMaxInBufferSubset(uint16_t start, uint16_t count) const
+{
+  if (start >= _count) return 0;
+  uint16_t cnt = _count - start;
+  if (cnt > count) cnt = count;
+  if (cnt == 0) return 0;
+
+  return _rangeMinMax(start, cnt, true);
+}
+
+
+//  maps position (0 = oldest) to the index in _array.
+template <typename T, typename A, uint16_t F>
+uint16_t RunningAverage<T, A, F>::_slot(uint16_t position) const
+{
+  uint32_t idx = (uint32_t)_index + _partial - _count + position;
+  while (idx >= _partial) idx -= _partial;
+  return idx;
+}
+
+
+//  sum of count elements from position on, 0 = oldest.
+//  one subtraction with RA_PREFIX, otherwise iterates.
+template <typename T, typename A, uint16_t F>
+A RunningAverage<T, A, F>::_rangeSum(uint16_t position, uint16_t count) const
+{
+  if (F & RA_PREFIX)
+  {
+    A last = (position + count < _count) ? _prefixAt(_slot(position + count)) : _total;
+    return last - _prefixAt(_slot(position));
+  }
+
+  A sum = 0;   //  do not disrupt global _sum
+  uint16_t idx = _slot(position);
+  for (uint16_t i = 0; i < count; i++)
+  {
+    sum += _at(idx);
+    idx++;
+    if (idx == _partial) idx = 0;
+  }
+  return sum;
+}
+
+//  min or max of count elements from position on, 0 = oldest.
+//  a chronological range covers at most two runs of slots.
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::_rangeMinMax(uint16_t position, uint16_t count, bool maximum) const
+{
+  uint16_t first = _slot(position);
+  uint32_t last  = (uint32_t)first + count;   //  exclusive
+  if (last <= _partial)
+  {
+    return _slotMinMax(first, last, maximum);
+  }
+  T a = _slotMinMax(first, _partial, maximum);
+  T b = _slotMinMax(0, last - _partial, maximum);
+  if (maximum) return (a > b) ? a : b;
+  return (a < b) ? a : b;
+}
+
+
+//  min or max of _array[first .. last), first < last.
+//  O(log N) with RA_RANGE, otherwise iterates.
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::_slotMinMax(uint16_t first, uint16_t last, bool maximum) const
+{
+  if (F & RA_RANGE)
+  {
+    const T * tree = maximum ? _tree + 2UL * _size : _tree;
+    T result = tree[_size + first];
+    uint32_t lo = (uint32_t)_size + first;
+    uint32_t hi = (uint32_t)_size + last;
+    while (lo < hi)
+    {
+      if (lo & 1)
+      {
+        T v = tree[lo++];
+        if (maximum ? (v > result) : (v < result)) result = v;
+      }
+      if (hi & 1)
+      {
+        T v = tree[--hi];
+        if (maximum ? (v > result) : (v < result)) result = v;
+      }
+      lo >>= 1;
+      hi >>= 1;
+    }
+    return result;
+  }
+
+  //  split around the lazy filled slots.
+  uint16_t lo = (first > _fillLow) ? first : _fillLow;
+  uint16_t hi = (last  < _fillEnd) ? last  : _fillEnd;
+  if (lo >= hi)
+  {
+    if (maximum) return ra_max(_array + first, last - first);
+    return ra_min(_array + first, last - first);
+  }
+  T result = _fillValue;
+  if (first < lo)
+  {
+    T v = maximum ? ra_max(_array + first, lo - first) : ra_min(_array + first, lo - first);
+    if (maximum ? (v > result) : (v < result)) result = v;
+  }
+  if (hi < last)
+  {
+    T v = maximum ? ra_max(_array + hi, last - hi) : ra_min(_array + hi, last - hi);
+    if (maximum ? (v > result) : (v < result)) result = v;
+  }
+  return result;
+}
+
+
+//  sum of _array[first .. last), lazy filled slots count as _fillValue.
+template <typename T, typename A, uint16_t F>
+A RunningAverage<T, A, F>::_slotSum(uint16_t first, uint16_t last) const
+{
+  uint16_t lo = (first > _fillLow) ? first : _fillLow;
+  uint16_t hi = (last  < _fillEnd) ? last  : _fillEnd;
+  if (lo >= hi) return ra_sum(_array + first, last - first);
+  A sum = ra_sum(_array + first, lo - first);
+  sum += (A)_fillValue * (hi - lo);
+  sum += ra_sum(_array + hi, last - hi);
+  return sum;
+}
+
+
+template <typename T, typename A, uint16_t F>
+uint64_t RunningAverage<T, A, F>::_slotSumSquares(uint16_t first, uint16_t last) const
+{
+  uint16_t lo = (first > _fillLow) ? first : _fillLow;
+  uint16_t hi = (last  < _fillEnd) ? last  : _fillEnd;
+  if (lo >= hi) return ra_sumSquares(_array + first, last - first);
+  uint64_t fill = _fillValue;
+  uint64_t sum = ra_sumSquares(_array + first, lo - first);
+  sum += fill * fill * (hi - lo);
+  sum += ra_sumSquares(_array + hi, last - hi);
+  return sum;
+}
+
+
+//  RA_RANGE, rebuild both trees from _array, O(N).
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::_treeBuild()
+{
+  T * minTree = _tree;
+  T * maxTree = _tree + 2UL * _size;
+  for (uint16_t i = 0; i < _size; i++)
+  {
+    minTree[_size + i] = maxTree[_size + i] = _array[i];
+  }
+  for (uint32_t i = _size - 1; i > 0; i--)
+  {
+    T a = minTree[2 * i];
+    T b = minTree[2 * i + 1];
+    minTree[i] = (a < b) ? a : b;
+    a = maxTree[2 * i];
+    b = maxTree[2 * i + 1];
+    maxTree[i] = (a > b) ? a : b;
+  }
+}
+
+
+//  RA_RANGE, update the leaf and its ancestors, O(log N).
+template <typename T, typename A, uint16_t F>
+void RunningAverage<T, A, F>::_treeSet(uint16_t idx, const T value)
+{
+  T * minTree = _tree;
+  T * maxTree = _tree + 2UL * _size;
+  uint32_t i = (uint32_t)_size + idx;
+  minTree[i] = value;
+  maxTree[i] = value;
+  while (i > 1)
+  {
+    i >>= 1;
+    T a = minTree[2 * i];
+    T b = minTree[2 * i + 1];
+    minTree[i] = (a < b) ? a : b;
+    a = maxTree[2 * i];
+    b = maxTree[2 * i + 1];
+    maxTree[i] = (a > b) ? a : b;
+  }
+}
+
+
+//  RA_HISTOGRAM, coarse scan then fine scan, at most 256 + 256 bins.
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getElementByRank(uint16_t rank) const
+{
+  if (!(F & RA_HISTOGRAM) || (rank >= _count)) return 0;
+
+  const uint16_t * coarse = _histogram + 65536UL;
+  uint16_t c = 0;
+  while (rank >= coarse[c])
+  {
+    rank -= coarse[c];
+    c++;
+  }
+  const uint16_t * fine = _histogram + 256UL * c;
+  uint16_t f = 0;
+  while (rank >= fine[f])
+  {
+    rank -= fine[f];
+    f++;
+  }
+  return (T)(256UL * c + f);
+}
+
+
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getQuantile(float q) const
+{
+  if (_count == 0) return 0;
+  if (q < 0) q = 0;
+  if (q > 1) q = 1;
+  return getElementByRank((uint16_t)(q * (_count - 1) + 0.5));
+}
+
+
+template <typename T, typename A, uint16_t F>
+T RunningAverage<T, A, F>::getMedian() const
+{
+  if (_count == 0) return 0;
+  uint16_t middle = _count / 2;
+  if (_count & 1) return getElementByRank(middle);
+  uint32_t low  = getElementByRank(middle - 1);
+  uint32_t high = getElementByRank(middle);
+  return (low + high) / 2;
+}
+
+}  //  namespace runningaverage
+
+
+//  backwards compatible default, 16 bit samples with a 32 bit sum
+//  which is exact for any window up to 65535 elements.
+//  the global names clash with using namespace runningaverage;
+//  define RA_NO_GLOBAL_NAMES before the includes to leave them out.
+#if !defined(RA_NO_GLOBAL_NAMES)
+typedef runningaverage::RunningAverage<uint16_t, uint32_t, 0> RunningAverage;
+#endif
+
+
 //  -- END OF FILE --
 
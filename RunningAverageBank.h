@@ -0,0 +1,240 @@
+#pragma once
+//
+//    FILE: RunningAverageBank.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: Arduino library to calculate the running average by means of a circular buffer
+//          bank of many channels with the same size in one allocation.
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  One RunningAverage per channel costs a malloc, a header and a pointer each.
+//  The bank stores the headers as arrays (structure of arrays), so a readout
+//  of all channels is a linear sweep over the sums and counts.
+//  The rings of the channels follow each other in one block.
+//
+//  memory layout of the single allocation:
+//    A   sum[channels]
+//    T   min[channels], max[channels]
+//    T   ring[channels * size]
+//    u16 count[channels], index[channels]
+
+
+#include "RunningAverage.h"
+
+
+namespace runningaverage
+{
+
+template <typename T = uint16_t, typename A = uint32_t>
+class RunningAverageBank
+{
+public:
+  explicit RunningAverageBank(const uint16_t channels, const uint16_t size);
+  ~RunningAverageBank();
+
+  //  owns raw buffers, not copyable.
+  RunningAverageBank(const RunningAverageBank &) = delete;
+  RunningAverageBank & operator = (const RunningAverageBank &) = delete;
+
+  //  all channels or one channel
+  void     clear();
+  void     clear(const uint16_t channel);
+
+  void     add(const uint16_t channel, const T value) { addValue(channel, value); };
+  void     addValue(const uint16_t channel, const T value);
+
+  T        getValue(const uint16_t channel, const uint16_t position) const;
+  T        getAverage(const uint16_t channel) const;      //  iterates over the ring
+  T        getFastAverage(const uint16_t channel) const;  //  uses running sum
+  //  out[] must hold getChannels() elements, empty channels give 0.
+  void     getFastAverages(T * out) const;
+
+  T        getMin(const uint16_t channel) const { return (channel < _channels) ? _min[channel] : 0; };
+  T        getMax(const uint16_t channel) const { return (channel < _channels) ? _max[channel] : 0; };
+  A        getSum(const uint16_t channel) const { return (channel < _channels) ? _sum[channel] : 0; };
+  uint16_t getCount(const uint16_t channel) const { return (channel < _channels) ? _count[channel] : 0; };
+  bool     bufferIsFull(const uint16_t channel) const { return getCount(channel) == _size; };
+
+  uint16_t getChannels() const { return _channels; };
+  uint16_t getSize() const { return _size; };
+
+
+protected:
+  uint16_t _channels;
+  uint16_t _size;
+  void *   _block;
+
+  //  hot arrays, indexed by channel
+  A *      _sum;
+  T *      _min;
+  T *      _max;
+  uint16_t * _count;
+  uint16_t * _index;
+  //  cold, ring of channel c starts at _ring + c * _size
+  T *      _ring;
+
+  T *      _ringOf(const uint16_t channel) const { return _ring + (uint32_t)channel * _size; };
+  static size_t _align(size_t offset, size_t alignment)
+  {
+    return (offset + alignment - 1) / alignment * alignment;
+  };
+};
+
+
+///////////////////////////////////////////////////////////////
+//
+//  IMPLEMENTATION
+//
+template <typename T, typename A>
+RunningAverageBank<T, A>::RunningAverageBank(const uint16_t channels, const uint16_t size)
+{
+  _channels = channels;
+  _size = size;
+
+  size_t offsetMin   = _align(_channels * sizeof(A), alignof(T));
+  size_t offsetMax   = offsetMin + _channels * sizeof(T);
+  size_t offsetRing  = offsetMax + _channels * sizeof(T);
+  size_t offsetCount = _align(offsetRing + (size_t)_channels * _size * sizeof(T), alignof(uint16_t));
+  size_t offsetIndex = offsetCount + _channels * sizeof(uint16_t);
+  size_t bytes       = offsetIndex + _channels * sizeof(uint16_t);
+
+  _block = (_channels && _size) ? malloc(bytes) : NULL;
+  if (_block == NULL)
+  {
+    _channels = _size = 0;
+    _sum   = NULL;
+    _min   = _max = _ring = NULL;
+    _count = _index = NULL;
+    return;
+  }
+  uint8_t * base = (uint8_t *) _block;
+  _sum   = (A *) base;
+  _min   = (T *) (base + offsetMin);
+  _max   = (T *) (base + offsetMax);
+  _ring  = (T *) (base + offsetRing);
+  _count = (uint16_t *) (base + offsetCount);
+  _index = (uint16_t *) (base + offsetIndex);
+  clear();
+}
+
+
+template <typename T, typename A>
+RunningAverageBank<T, A>::~RunningAverageBank()
+{
+  if (_block != NULL) free(_block);
+  _block = NULL;
+}
+
+
+//  O(channels), the rings are not zeroed.
+template <typename T, typename A>
+void RunningAverageBank<T, A>::clear()
+{
+  for (uint16_t c = 0; c < _channels; c++)
+  {
+    _sum[c] = 0;
+    _min[c] = 0;
+    _max[c] = 0;
+    _count[c] = 0;
+    _index[c] = 0;
+  }
+}
+
+
+template <typename T, typename A>
+void RunningAverageBank<T, A>::clear(const uint16_t channel)
+{
+  if (channel >= _channels) return;
+  _sum[channel] = 0;
+  _min[channel] = 0;
+  _max[channel] = 0;
+  _count[channel] = 0;
+  _index[channel] = 0;
+}
+
+
+template <typename T, typename A>
+void RunningAverageBank<T, A>::addValue(const uint16_t channel, const T value)
+{
+  if (channel >= _channels) return;
+
+  T * ring = _ringOf(channel);
+  uint16_t idx = _index[channel];
+  uint16_t cnt = _count[channel];
+
+  //  the oldest value leaves when the ring is full.
+  if (cnt == _size) _sum[channel] -= ring[idx];
+  ring[idx] = value;
+  _sum[channel] += value;
+  idx++;
+  if (idx == _size) idx = 0;
+  _index[channel] = idx;
+
+  //  handle min max
+  if ((cnt == 0) || (value < _min[channel])) _min[channel] = value;
+  if ((cnt == 0) || (value > _max[channel])) _max[channel] = value;
+
+  if (cnt < _size) _count[channel] = cnt + 1;
+}
+
+
+//  position 0 is the oldest value of the channel.
+template <typename T, typename A>
+T RunningAverageBank<T, A>::getValue(const uint16_t channel, const uint16_t position) const
+{
+  if (channel >= _channels) return 0;
+  uint16_t cnt = _count[channel];
+  if (position >= cnt) return 0;
+
+  uint16_t pos = position + _index[channel];
+  if (pos >= cnt) pos -= cnt;
+  return _ringOf(channel)[pos];
+}
+
+
+template <typename T, typename A>
+T RunningAverageBank<T, A>::getAverage(const uint16_t channel) const
+{
+  if (channel >= _channels) return 0;
+  uint16_t cnt = _count[channel];
+  if (cnt == 0) return 0;
+  A sum = ra_sum(_ringOf(channel), cnt);
+  return sum / cnt;
+}
+
+
+template <typename T, typename A>
+T RunningAverageBank<T, A>::getFastAverage(const uint16_t channel) const
+{
+  if (channel >= _channels) return 0;
+  uint16_t cnt = _count[channel];
+  if (cnt == 0) return 0;
+  return _sum[channel] / cnt;
+}
+
+
+//  linear sweep over the sum and count arrays only.
+template <typename T, typename A>
+void RunningAverageBank<T, A>::getFastAverages(T * out) const
+{
+  const A * sum = _sum;
+  const uint16_t * count = _count;
+  for (uint16_t c = 0; c < _channels; c++)
+  {
+    uint16_t cnt = count[c];
+    out[c] = (cnt == 0) ? 0 : sum[c] / cnt;
+  }
+}
+
+}  //  namespace runningaverage
+
+
+#if !defined(RA_NO_GLOBAL_NAMES)
+template <typename T = uint16_t, typename A = uint32_t>
+using RunningAverageBank = runningaverage::RunningAverageBank<T, A>;
+#endif
+
+
+//  -- END OF FILE --
+
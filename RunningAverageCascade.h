@@ -0,0 +1,286 @@
+#pragma once
+//
+//    FILE: RunningAverageCascade.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: Arduino library to calculate the running average by means of a circular buffer
+//          cascade of windows with increasing resolution, e.g. second, minute, hour, day.
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  Level 0 is a RunningAverage of the raw samples.
+//  Every time level k has received sizes[k] new entries, the aggregate of
+//  these entries (sum, count, min, max) is added as one block to level k + 1.
+//  The aggregate is kept incrementally, so the rollup is O(1).
+//  Memory is about the sum of the level sizes, not the whole raw history.
+//
+//  sizes {60, 60, 24, 7} with one sample per second gives the last minute,
+//  hour, day and week, 151 entries instead of 604800 samples.
+//  A must hold the number of samples covered by the top level * max(T).
+
+
+#include "RunningAverage.h"
+
+
+namespace runningaverage
+{
+
+const uint8_t RA_CASCADE_LEVELS = 6;
+
+
+//  aggregate of count samples.
+template <typename T = uint16_t, typename A = uint64_t>
+struct RA_Block
+{
+  A        sum;
+  uint32_t count;
+  T        minimum;
+  T        maximum;
+};
+
+
+///////////////////////////////////////////////////////////////
+//
+//  RA_BlockWindow, running window of blocks, the getters of RunningAverage
+//  apply to the samples in the blocks, getCount() counts blocks.
+//
+template <typename T = uint16_t, typename A = uint64_t>
+class RA_BlockWindow
+{
+public:
+  explicit RA_BlockWindow(const uint16_t size)
+  {
+    _size = size;
+    _blocks = (RA_Block<T, A> *) malloc(_size * sizeof(RA_Block<T, A>));
+    _deques = (uint16_t *) malloc(2 * _size * sizeof(uint16_t));
+    //  malloc(0) may return a pointer, size 0 counts as failed.
+    if ((_size == 0) || (_blocks == NULL) || (_deques == NULL))
+    {
+      _release();
+      _size = 0;
+    }
+    _minDeque.begin(_deques, _size);
+    _maxDeque.begin(_deques + _size, _size);
+    clear();
+  };
+
+  ~RA_BlockWindow() { _release(); };
+
+  //  owns raw buffers, not copyable.
+  RA_BlockWindow(const RA_BlockWindow &) = delete;
+  RA_BlockWindow & operator = (const RA_BlockWindow &) = delete;
+
+  void     clear()
+  {
+    _count = 0;
+    _index = 0;
+    _sum = 0;
+    _samples = 0;
+    _min = 0;
+    _max = 0;
+    _minDeque.clear();
+    _maxDeque.clear();
+  };
+
+  //  O(1) amortized, same monotonic deques as RA_MINMAX.
+  void     addBlock(const RA_Block<T, A> & block)
+  {
+    if (_blocks == NULL) return;
+    if (_count == _size)
+    {
+      _sum -= _blocks[_index].sum;
+      _samples -= _blocks[_index].count;
+      if (_minDeque.front() == _index) _minDeque.popFront();
+      if (_maxDeque.front() == _index) _maxDeque.popFront();
+    }
+    while (!_minDeque.empty() && (_blocks[_minDeque.back()].minimum >= block.minimum)) _minDeque.popBack();
+    while (!_maxDeque.empty() && (_blocks[_maxDeque.back()].maximum <= block.maximum)) _maxDeque.popBack();
+    _minDeque.pushBack(_index);
+    _maxDeque.pushBack(_index);
+
+    _blocks[_index] = block;
+    _sum += block.sum;
+    _samples += block.count;
+    _index++;
+    if (_index == _size) _index = 0;
+
+    _min = ((_count == 0) || (block.minimum < _min)) ? block.minimum : _min;
+    _max = ((_count == 0) || (block.maximum > _max)) ? block.maximum : _max;
+    _count += (_count < _size);
+  };
+
+  //  average of all samples in the window, O(1).
+  T        getAverage() const     { return (_samples == 0) ? 0 : _sum / _samples; };
+  T        getFastAverage() const { return getAverage(); };
+  A        getSum() const         { return _sum; };
+  //  since clear()
+  T        getMin() const         { return _min; };
+  T        getMax() const         { return _max; };
+  //  in the window
+  T        getMinInBuffer() const { return (_count == 0) ? 0 : _blocks[_minDeque.front()].minimum; };
+  T        getMaxInBuffer() const { return (_count == 0) ? 0 : _blocks[_maxDeque.front()].maximum; };
+
+  //  average of one block, position 0 is the oldest.
+  T        getValue(const uint16_t position) const
+  {
+    const RA_Block<T, A> * block = getBlock(position);
+    if ((block == NULL) || (block->count == 0)) return 0;
+    return block->sum / block->count;
+  };
+  const RA_Block<T, A> * getBlock(const uint16_t position) const
+  {
+    if (position >= _count) return NULL;
+    uint16_t pos = position + _index;
+    if (pos >= _count) pos -= _count;
+    return &_blocks[pos];
+  };
+
+  bool     bufferIsFull() const   { return _count == _size; };
+  uint16_t getCount() const       { return _count; };    //  blocks
+  uint32_t getSampleCount() const { return _samples; };  //  samples in the blocks
+  uint16_t getSize() const        { return _size; };
+
+
+protected:
+  uint16_t _size;
+  uint16_t _count;
+  uint16_t _index;
+  A        _sum;
+  uint32_t _samples;
+  T        _min;
+  T        _max;
+  RA_Block<T, A> * _blocks;
+  uint16_t * _deques;
+  RA_Deque _minDeque;
+  RA_Deque _maxDeque;
+
+  void     _release()
+  {
+    if (_blocks != NULL) free(_blocks);
+    if (_deques != NULL) free(_deques);
+    _blocks = NULL;
+    _deques = NULL;
+  };
+};
+
+
+///////////////////////////////////////////////////////////////
+//
+//  RunningAverageCascade
+//
+template <typename T = uint16_t, typename A = uint64_t>
+class RunningAverageCascade
+{
+public:
+  //  levels <= RA_CASCADE_LEVELS, sizes[levels] window size per level.
+  RunningAverageCascade(uint8_t levels, const uint16_t * sizes)
+  : _samples(sizes[0])
+  {
+    if (levels > RA_CASCADE_LEVELS) levels = RA_CASCADE_LEVELS;
+    _levels = levels;
+    for (uint8_t k = 0; k < RA_CASCADE_LEVELS; k++)
+    {
+      _level[k] = NULL;
+      _factor[k] = (k < _levels) ? sizes[k] : 0;
+    }
+    for (uint8_t k = 1; k < _levels; k++)
+    {
+      _level[k] = new RA_BlockWindow<T, A>(sizes[k]);
+    }
+    clear();
+  };
+
+  ~RunningAverageCascade()
+  {
+    for (uint8_t k = 1; k < _levels; k++) delete _level[k];
+  };
+
+  //  owns raw buffers, not copyable.
+  RunningAverageCascade(const RunningAverageCascade &) = delete;
+  RunningAverageCascade & operator = (const RunningAverageCascade &) = delete;
+
+  void     clear()
+  {
+    _samples.clear();
+    for (uint8_t k = 0; k < _levels; k++)
+    {
+      if (_level[k] != NULL) _level[k]->clear();
+      _pending[k].sum = 0;
+      _pending[k].count = 0;
+      _entries[k] = 0;
+    }
+  };
+
+  void     add(const T value) { addValue(value); };
+  void     addValue(const T value)
+  {
+    _samples.addValue(value);
+    RA_Block<T, A> block;
+    block.sum = value;
+    block.count = 1;
+    block.minimum = value;
+    block.maximum = value;
+    _rollup(block);
+  };
+
+  //  level 0, the raw samples.
+  RunningAverage<T, A, RA_MINMAX> & getSamples() { return _samples; };
+  //  level 1 .. levels - 1, NULL otherwise.
+  RA_BlockWindow<T, A> * getLevel(const uint8_t level)
+  {
+    if ((level == 0) || (level >= _levels)) return NULL;
+    return _level[level];
+  };
+  uint8_t  getLevels() const { return _levels; };
+
+
+protected:
+  uint8_t  _levels;
+  RunningAverage<T, A, RA_MINMAX> _samples;
+  RA_BlockWindow<T, A> * _level[RA_CASCADE_LEVELS];
+  uint16_t _factor[RA_CASCADE_LEVELS];
+  //  aggregate of the entries of level k since its last rollup.
+  RA_Block<T, A> _pending[RA_CASCADE_LEVELS];
+  uint16_t _entries[RA_CASCADE_LEVELS];
+
+  //  merge an entry of level k into its pending block,
+  //  a completed block is one entry of level k + 1.
+  void     _rollup(const RA_Block<T, A> & sample)
+  {
+    RA_Block<T, A> entry = sample;
+    for (uint8_t k = 0; k + 1 < _levels; k++)
+    {
+      RA_Block<T, A> & p = _pending[k];
+      if (p.count == 0)
+      {
+        p = entry;
+      }
+      else
+      {
+        p.sum += entry.sum;
+        p.count += entry.count;
+        if (entry.minimum < p.minimum) p.minimum = entry.minimum;
+        if (entry.maximum > p.maximum) p.maximum = entry.maximum;
+      }
+      if (++_entries[k] < _factor[k]) return;
+
+      entry = p;
+      p.sum = 0;
+      p.count = 0;
+      _entries[k] = 0;
+      if (_level[k + 1] != NULL) _level[k + 1]->addBlock(entry);
+    }
+  };
+};
+
+}  //  namespace runningaverage
+
+
+#if !defined(RA_NO_GLOBAL_NAMES)
+template <typename T = uint16_t, typename A = uint64_t>
+using RunningAverageCascade = runningaverage::RunningAverageCascade<T, A>;
+#endif
+
+
+//  -- END OF FILE --
+
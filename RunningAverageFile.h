@@ -0,0 +1,132 @@
+#pragma once
+//
+//    FILE: RunningAverageFile.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: Arduino library to calculate the running average by means of a circular buffer
+//          save many windows in one file, restore them from a mmap'd file (hosted).
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  The file is the serialize() blobs of the windows back to back.
+//  RunningAverageFile maps it copy on write and attach()es the windows to
+//  their blobs, so a restart costs no copy per sample, the pages are read
+//  on first use. Updates of the windows do not change the file.
+//
+//  POSIX only (mmap), RA_HAS_MMAP is defined when available.
+
+
+#include "RunningAverage.h"
+
+#if !defined(__AVR__) && defined(__has_include)
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#define RA_HAS_MMAP                   1
+#endif
+#endif
+
+
+#if defined(RA_HAS_MMAP)
+
+namespace runningaverage
+{
+
+//  writes the windows to path, returns false on an IO or memory error.
+template <typename T, typename A, uint16_t F>
+bool ra_saveWindows(const char * path, const RunningAverage<T, A, F> * windows, uint32_t number)
+{
+  FILE * file = fopen(path, "wb");
+  if (file == NULL) return false;
+  bool ok = true;
+  for (uint32_t i = 0; ok && (i < number); i++)
+  {
+    size_t bytes = windows[i].serializedSize();
+    uint8_t * blob = (uint8_t *) malloc(bytes);
+    ok = (blob != NULL) && (windows[i].serialize(blob, bytes) == bytes);
+    ok = ok && (fwrite(blob, 1, bytes, file) == bytes);
+    free(blob);
+  }
+  if (fclose(file) != 0) ok = false;
+  return ok;
+}
+
+
+class RunningAverageFile
+{
+public:
+  RunningAverageFile()  { _data = NULL; _length = 0; };
+  ~RunningAverageFile() { close(); };
+
+  //  owns the mapping, not copyable.
+  RunningAverageFile(const RunningAverageFile &) = delete;
+  RunningAverageFile & operator = (const RunningAverageFile &) = delete;
+
+  //  maps path private (copy on write), false if that fails.
+  bool     open(const char * path)
+  {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0))
+    {
+      ::close(fd);
+      return false;
+    }
+    void * p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    _data = (uint8_t *) p;
+    _length = st.st_size;
+    return true;
+  };
+
+  //  the attached windows must not be used after close().
+  void     close()
+  {
+    if (_data != NULL) munmap(_data, _length);
+    _data = NULL;
+    _length = 0;
+  };
+
+  //  attaches up to number windows in file order, returns the number attached.
+  //  stops at the first invalid blob.
+  template <class RA>
+  uint32_t restore(RA * windows, uint32_t number)
+  {
+    size_t offset = 0;
+    uint32_t i = 0;
+    while ((i < number) && (offset < _length))
+    {
+      if (!windows[i].attach(_data + offset, _length - offset)) break;
+      offset += windows[i].serializedSize();
+      i++;
+    }
+    return i;
+  };
+
+  uint8_t * data() const       { return _data; };
+  size_t   length() const      { return _length; };
+
+
+protected:
+  uint8_t * _data;
+  size_t    _length;
+};
+
+}  //  namespace runningaverage
+
+
+#if !defined(RA_NO_GLOBAL_NAMES)
+using RunningAverageFile = runningaverage::RunningAverageFile;
+#endif
+
+#endif
+
+
+//  -- END OF FILE --
+
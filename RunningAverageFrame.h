@@ -0,0 +1,132 @@
+#pragma once
+//
+//    FILE: RunningAverageFrame.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: Arduino library to calculate the running average by means of a circular buffer
+//          per pixel average over the last N frames, e.g. a depth camera.
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  Same ring and running sum as RunningAverage::addValue(), for every pixel at once.
+//  The ring holds whole frames, so pixel i of all frames sits at the same offset
+//  and one SIMD lane handles one pixel (see RunningAverageSIMD.h).
+//  addFrame() is one pass that subtracts the oldest frame, adds the new one
+//  and overwrites the oldest in the ring.
+
+
+#include "RunningAverage.h"
+
+
+namespace runningaverage
+{
+
+class RunningAverageFrame
+{
+public:
+  explicit RunningAverageFrame(const uint32_t pixels, const uint16_t size)
+  {
+    _pixels = pixels;
+    _size = size;
+    _frames = (uint16_t *) malloc((size_t)_pixels * _size * sizeof(uint16_t));
+    _sums   = (uint32_t *) malloc((size_t)_pixels * sizeof(uint32_t));
+    if ((_frames == NULL) || (_sums == NULL) || (_pixels == 0) || (_size == 0))
+    {
+      _release();
+      _pixels = 0;
+      _size = 0;
+    }
+    clear();
+  };
+
+  ~RunningAverageFrame() { _release(); };
+
+  //  owns raw buffers, not copyable.
+  RunningAverageFrame(const RunningAverageFrame &) = delete;
+  RunningAverageFrame & operator = (const RunningAverageFrame &) = delete;
+
+  //  O(pixels), the ring is not zeroed.
+  void     clear()
+  {
+    _count = 0;
+    _index = 0;
+    if (_sums != NULL) memset(_sums, 0, (size_t)_pixels * sizeof(uint32_t));
+  };
+
+  //  frame[] holds getPixels() values.
+  void     addFrame(const uint16_t * frame)
+  {
+    if (_frames == NULL) return;
+    ra_frameAdd(_sums, _slot(_index), frame, _pixels, _count == _size);
+    _index++;
+    if (_index == _size) _index = 0;
+    _count += (_count < _size);
+  };
+
+  //  out[] must hold getPixels() values, false if there is no frame yet.
+  bool     getAverage(uint16_t * out) const
+  {
+    if (_count == 0) return false;
+    ra_frameAverage(out, _sums, _pixels, _count);
+    return true;
+  };
+  //  per pixel min / max over the frames in the ring, O(count * pixels).
+  bool     getMin(uint16_t * out) const
+  {
+    if (_count == 0) return false;
+    ra_frameMin(out, _frames, _count, _pixels);
+    return true;
+  };
+  bool     getMax(uint16_t * out) const
+  {
+    if (_count == 0) return false;
+    ra_frameMax(out, _frames, _count, _pixels);
+    return true;
+  };
+
+  //  position 0 is the oldest frame, NULL if out of range.
+  const uint16_t * getFrame(const uint16_t position) const
+  {
+    if (position >= _count) return NULL;
+    uint16_t pos = position + _index;
+    if (pos >= _count) pos -= _count;
+    return _slot(pos);
+  };
+  //  running sum of one pixel.
+  uint32_t getSum(const uint32_t pixel) const { return (pixel < _pixels) ? _sums[pixel] : 0; };
+
+  bool     bufferIsFull() const { return _count == _size; };
+  uint16_t getCount() const     { return _count; };
+  uint16_t getSize() const      { return _size; };
+  uint32_t getPixels() const    { return _pixels; };
+
+
+protected:
+  uint32_t   _pixels;
+  uint16_t   _size;
+  uint16_t   _count;
+  uint16_t   _index;
+  uint16_t * _frames;  //  _size frames of _pixels values
+  uint32_t * _sums;    //  running sum per pixel
+
+  uint16_t * _slot(const uint16_t idx) const { return _frames + (size_t)idx * _pixels; };
+
+  void       _release()
+  {
+    if (_frames != NULL) free(_frames);
+    if (_sums   != NULL) free(_sums);
+    _frames = NULL;
+    _sums   = NULL;
+  };
+};
+
+}  //  namespace runningaverage
+
+
+#if !defined(RA_NO_GLOBAL_NAMES)
+using RunningAverageFrame = runningaverage::RunningAverageFrame;
+#endif
+
+
+//  -- END OF FILE --
+
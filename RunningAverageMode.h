@@ -0,0 +1,241 @@
+#pragma once
+//
+//    FILE: RunningAverageMode.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: Arduino library to calculate the running average by means of a circular buffer
+//          exact mode (most frequent value) of the window, e.g. stuck sensor detection.
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  RunningAverage that also counts how often every code 0 .. 2^BITS - 1
+//  is in the window. Codes with the same count are kept in a doubly linked
+//  list per count, so insert, evict and getMode() are O(1).
+//  RAM: 6 x 2^BITS bytes + 2 x (size + 1) bytes, e.g. BITS = 10 ==> 6 KB.
+//  Values >= 2^BITS are counted as 2^BITS - 1.
+//
+//  Tie break: of the codes with the highest count, getMode() returns the one
+//  whose count changed last, by an addValue() or by an eviction.
+
+
+#include "RunningAverage.h"
+
+
+namespace runningaverage
+{
+
+template <uint8_t BITS, typename T = uint16_t, typename A = uint32_t, uint16_t F = 0>
+class RunningAverageMode : public RunningAverage<T, A, F>
+{
+  typedef RunningAverage<T, A, F> Base;
+
+public:
+  static_assert((BITS > 0) && (BITS <= 15), "RunningAverageMode supports 1 .. 15 bit codes");
+  static const uint16_t CODES = 1U << BITS;
+
+  explicit RunningAverageMode(const uint16_t size) : Base(size)
+  {
+    _counts = (uint16_t *) calloc(CODES, sizeof(uint16_t));
+    _next   = (uint16_t *) malloc(CODES * sizeof(uint16_t));
+    _prev   = (uint16_t *) malloc(CODES * sizeof(uint16_t));
+    _heads  = (uint16_t *) malloc((this->_size + 1UL) * sizeof(uint16_t));
+    if ((_counts == NULL) || (_next == NULL) || (_prev == NULL) || (_heads == NULL))
+    {
+      _releaseMode();
+      Base::_release();
+      this->_size = this->_capacity = this->_partial = 0;
+    }
+    for (uint32_t f = 0; (_heads != NULL) && (f <= this->_size); f++) _heads[f] = NIL;
+    _headsSize = this->_size;
+    _maxCount = 0;
+  };
+
+  ~RunningAverageMode() { _releaseMode(); };
+
+  //  owns raw buffers, not copyable.
+  RunningAverageMode(const RunningAverageMode &) = delete;
+  RunningAverageMode & operator = (const RunningAverageMode &) = delete;
+
+  //  these hide the RunningAverage versions to keep the counts in sync.
+  //  O(count) as the values of the buffer are removed from the counts.
+  void     clear()
+  {
+    _forget();
+    Base::clear();
+  };
+  void     add(const T value) { addValue(value); };
+  void     addValue(const T value)
+  {
+    if (this->_array == NULL) return;
+    if (this->_count == this->_partial) _decrement(_code(this->_at(this->_index)));
+    Base::addValue(value);
+    _increment(_code(value));
+  };
+  void     addValues(const T * values, size_t number)
+  {
+    for (size_t i = 0; i < number; i++) addValue(values[i]);
+  };
+  //  O(count) for the clear, O(1) for the fill.
+  void     fillValue(const T value, const uint16_t number)
+  {
+    clear();
+    Base::fillValue(value, number);
+    if (this->_count == 0) return;
+    uint16_t code = _code(value);
+    _counts[code] = this->_count;
+    _push(code, this->_count);
+    _maxCount = this->_count;
+  };
+  //  O(count), the kept values are counted again.
+  void     setPartial(const uint16_t partial = 0)
+  {
+    _forget();
+    Base::setPartial(partial);
+    _recount();
+  };
+  bool     resize(const uint16_t size)
+  {
+    if (!_growHeads(size)) return false;
+    _forget();
+    bool rv = Base::resize(size);
+    _recount();
+    return rv;
+  };
+  bool     deserialize(const uint8_t * blob, size_t length)
+  {
+    typename Base::_Serial header;
+    if (!Base::_parse(blob, length, header) || !_growHeads(header.size)) return false;
+    _forget();
+    bool rv = Base::deserialize(blob, length);
+    _recount();
+    return rv;
+  };
+  bool     attach(uint8_t * blob, size_t length)
+  {
+    typename Base::_Serial header;
+    if (!Base::_parse(blob, length, header) || !_growHeads(header.size)) return false;
+    _forget();
+    bool rv = Base::attach(blob, length);
+    _recount();
+    return rv;
+  };
+
+  //  O(1), exchanges the windows with their counts.
+  //  hides RunningAverage::swap(), which would leave the counts behind.
+  void     swap(RunningAverageMode & other) noexcept
+  {
+    Base::swap(other);
+    Base::_exchange(_counts, other._counts);
+    Base::_exchange(_next, other._next);
+    Base::_exchange(_prev, other._prev);
+    Base::_exchange(_heads, other._heads);
+    Base::_exchange(_headsSize, other._headsSize);
+    Base::_exchange(_maxCount, other._maxCount);
+  };
+
+  //  most frequent value in the buffer, 0 if empty, O(1).
+  T        getMode() const        { return (_maxCount == 0) ? 0 : _heads[_maxCount]; };
+  //  how often getMode() is in the buffer.
+  uint16_t getModeCount() const   { return _maxCount; };
+  //  how often value is in the buffer, O(1).
+  uint16_t getFrequency(const T value) const
+  {
+    return (_counts == NULL) ? 0 : _counts[_code(value)];
+  };
+
+
+protected:
+  static const uint16_t NIL = 0xFFFF;
+
+  uint16_t * _counts;  //  per code
+  uint16_t * _next;    //  list of codes with the same count
+  uint16_t * _prev;
+  uint16_t * _heads;   //  per count, first code with that count
+  uint16_t   _headsSize;
+  uint16_t   _maxCount;
+
+  static uint16_t _code(const T value)
+  {
+    return (value >= CODES) ? CODES - 1 : (uint16_t)value;
+  };
+
+  void     _push(uint16_t code, uint16_t count)
+  {
+    _prev[code] = NIL;
+    _next[code] = _heads[count];
+    if (_heads[count] != NIL) _prev[_heads[count]] = code;
+    _heads[count] = code;
+  };
+  void     _unlink(uint16_t code, uint16_t count)
+  {
+    if (_prev[code] != NIL) _next[_prev[code]] = _next[code];
+    else _heads[count] = _next[code];
+    if (_next[code] != NIL) _prev[_next[code]] = _prev[code];
+  };
+
+  void     _increment(uint16_t code)
+  {
+    uint16_t c = _counts[code];
+    if (c > 0) _unlink(code, c);
+    c++;
+    _counts[code] = c;
+    _push(code, c);
+    if (c > _maxCount) _maxCount = c;
+  };
+  void     _decrement(uint16_t code)
+  {
+    uint16_t c = _counts[code];
+    if (c == 0) return;
+    _unlink(code, c);
+    if ((c == _maxCount) && (_heads[c] == NIL)) _maxCount--;
+    c--;
+    _counts[code] = c;
+    if (c > 0) _push(code, c);
+  };
+
+  //  _heads needs size + 1 entries, grows only.
+  bool     _growHeads(const uint16_t size)
+  {
+    if (_heads == NULL) return false;
+    if (size <= _headsSize) return true;
+    uint16_t * heads = (uint16_t *) realloc(_heads, (size + 1UL) * sizeof(uint16_t));
+    if (heads == NULL) return false;
+    _heads = heads;
+    for (uint32_t f = _headsSize + 1UL; f <= size; f++) _heads[f] = NIL;
+    _headsSize = size;
+    return true;
+  };
+
+  //  removes / adds the values of the buffer from / to the counts.
+  void     _forget()
+  {
+    if (_counts == NULL) return;
+    for (uint16_t i = 0; i < this->_count; i++) _decrement(_code(this->_at(i)));
+  };
+  void     _recount()
+  {
+    if (_counts == NULL) return;
+    for (uint16_t i = 0; i < this->_count; i++) _increment(_code(this->getValue(i)));
+  };
+
+  void     _releaseMode()
+  {
+    if (_counts != NULL) free(_counts);
+    if (_next   != NULL) free(_next);
+    if (_prev   != NULL) free(_prev);
+    if (_heads  != NULL) free(_heads);
+    _counts = _next = _prev = _heads = NULL;
+  };
+};
+
+}  //  namespace runningaverage
+
+
+#if !defined(RA_NO_GLOBAL_NAMES)
+template <uint8_t BITS, typename T = uint16_t, typename A = uint32_t, uint16_t F = 0>
+using RunningAverageMode = runningaverage::RunningAverageMode<BITS, T, A, F>;
+#endif
+
+
+//  -- END OF FILE --
+
@@ -0,0 +1,151 @@
+#pragma once
+//
+//    FILE: RunningAverageQueue.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: Arduino library to calculate the running average by means of a circular buffer
+//          single producer / single consumer staging queue in front of RunningAverage.
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  One producer (thread or ISR) calls addValue(), one consumer calls window()
+//  which drains the staged values into the RunningAverage in at most two
+//  addValues() blocks before it is queried.
+//  No locks, the producer does a store of the value and a release store of head.
+//  head and tail are on separate cache lines so the threads do not share one.
+//
+//  On AVR there is no <atomic>, the producer is expected to be an ISR and
+//  the 16 bit indices are read / written with interrupts disabled.
+
+
+#include "RunningAverage.h"
+
+#if !defined(__AVR__)
+#include <atomic>
+#define RA_CACHE_ALIGNED     alignas(64)
+#else
+#include <util/atomic.h>
+#define RA_CACHE_ALIGNED
+#endif
+
+
+namespace runningaverage
+{
+
+//  N = capacity of the queue, power of two, at most 32768.
+template <uint16_t N, typename T = uint16_t, typename A = uint32_t, uint16_t F = 0>
+class RunningAverageQueue
+{
+public:
+  static_assert((N > 0) && ((N & (N - 1)) == 0), "RunningAverageQueue needs a power of two capacity");
+  static_assert(N <= 32768, "RunningAverageQueue capacity is at most 32768");
+
+  explicit RunningAverageQueue(const uint16_t size) : _ra(size)
+  {
+    _head = 0;
+    _tail = 0;
+    _tailCache = 0;
+    _dropped = 0;
+  };
+
+  //  PRODUCER
+  //  returns false if the queue is full, the value is dropped.
+  bool     addValue(const T value)
+  {
+    uint16_t head = _loadRelaxed(_head);
+    if ((uint16_t)(head - _tailCache) == N)
+    {
+      //  only look at the consumer's line when the queue seems full.
+      _tailCache = _loadAcquire(_tail);
+      if ((uint16_t)(head - _tailCache) == N)
+      {
+        _storeRelaxed(_dropped, (uint32_t)(_loadRelaxed(_dropped) + 1));
+        return false;
+      }
+    }
+    _buffer[head & (N - 1)] = value;
+    _storeRelease(_head, (uint16_t)(head + 1));
+    return true;
+  };
+  void     add(const T value) { addValue(value); };
+
+
+  //  CONSUMER
+  //  moves all staged values into the window, returns the number moved.
+  uint16_t drain()
+  {
+    uint16_t tail = _loadRelaxed(_tail);
+    uint16_t head = _loadAcquire(_head);
+    uint16_t number = head - tail;
+    if (number == 0) return 0;
+
+    uint16_t first = tail & (N - 1);
+    uint16_t run = N - first;
+    if (run > number) run = number;
+    _ra.addValues(_buffer + first, run);
+    _ra.addValues(_buffer, number - run);
+
+    _storeRelease(_tail, head);
+    return number;
+  };
+
+  //  drains and returns the window, e.g. queue.window().getFastAverage();
+  RunningAverage<T, A, F> & window()
+  {
+    drain();
+    return _ra;
+  };
+
+  //  staged values, not yet in the window.
+  uint16_t available() const
+  {
+    return (uint16_t)(_loadAcquire(_head) - _loadRelaxed(_tail));
+  };
+  uint16_t getCapacity() const { return N; };
+  //  values dropped because the queue was full.
+  uint32_t getDropped() const  { return _loadRelaxed(_dropped); };
+
+
+protected:
+#if !defined(__AVR__)
+  typedef std::atomic<uint16_t> Index;
+  typedef std::atomic<uint32_t> Counter;
+
+  template <typename V> static V    _loadRelaxed(const std::atomic<V> & x) { return x.load(std::memory_order_relaxed); };
+  template <typename V> static V    _loadAcquire(const std::atomic<V> & x) { return x.load(std::memory_order_acquire); };
+  template <typename V> static void _storeRelaxed(std::atomic<V> & x, V v) { x.store(v, std::memory_order_relaxed); };
+  template <typename V> static void _storeRelease(std::atomic<V> & x, V v) { x.store(v, std::memory_order_release); };
+#else
+  typedef volatile uint16_t Index;
+  typedef volatile uint32_t Counter;
+
+  //  single core, volatile keeps the order, interrupts off avoid torn multi byte access.
+  //  ATOMIC_RESTORESTATE keeps interrupts off when called from the ISR.
+  template <typename V> static V    _loadRelaxed(const volatile V & x)  { V v; ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { v = x; } return v; };
+  template <typename V> static V    _loadAcquire(const volatile V & x)  { return _loadRelaxed(x); };
+  template <typename V> static void _storeRelaxed(volatile V & x, V v)  { ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { x = v; } };
+  template <typename V> static void _storeRelease(volatile V & x, V v)  { _storeRelaxed(x, v); };
+#endif
+
+  //  producer line
+  RA_CACHE_ALIGNED Index    _head;
+  uint16_t _tailCache;
+  Counter  _dropped;
+  //  consumer line
+  RA_CACHE_ALIGNED Index    _tail;
+  RunningAverage<T, A, F>   _ra;
+
+  RA_CACHE_ALIGNED T _buffer[N];
+};
+
+}  //  namespace runningaverage
+
+
+#if !defined(RA_NO_GLOBAL_NAMES)
+template <uint16_t N, typename T = uint16_t, typename A = uint32_t, uint16_t F = 0>
+using RunningAverageQueue = runningaverage::RunningAverageQueue<N, T, A, F>;
+#endif
+
+
+//  -- END OF FILE --
+
@@ -0,0 +1,695 @@
+//
+//    FILE: RunningAverageSIMD.cpp
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: reduction kernels over uint16_t arrays for RunningAverage
+//     URL: https://github.com/RobTillaart/RunningAverage
+
+
+#include "RunningAverageSIMD.h"
+
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RA_X86_SIMD
+#include <immintrin.h>
+#include <atomic>
+#endif
+
+
+namespace runningaverage
+{
+
+///////////////////////////////////////////////////////////////
+//
+//  SCALAR
+//
+static uint32_t sumScalar(const uint16_t * values, uint16_t number)
+{
+  uint32_t sum = 0;
+  for (uint16_t i = 0; i < number; i++) sum += values[i];
+  return sum;
+}
+
+
+static uint64_t sumSquaresScalar(const uint16_t * values, uint16_t number)
+{
+  uint64_t sum = 0;
+  for (uint16_t i = 0; i < number; i++)
+  {
+    uint32_t x = values[i];
+    sum += x * x;
+  }
+  return sum;
+}
+
+
+static uint16_t minScalar(const uint16_t * values, uint16_t number)
+{
+  uint16_t minimum = values[0];
+  for (uint16_t i = 1; i < number; i++)
+  {
+    if (values[i] < minimum) minimum = values[i];
+  }
+  return minimum;
+}
+
+
+static uint16_t maxScalar(const uint16_t * values, uint16_t number)
+{
+  uint16_t maximum = values[0];
+  for (uint16_t i = 1; i < number; i++)
+  {
+    if (values[i] > maximum) maximum = values[i];
+  }
+  return maximum;
+}
+
+
+//  frames, one pass reads the old and writes the new frame.
+static void frameAddScalar(uint32_t * sums, uint16_t * slot, const uint16_t * frame, uint32_t pixels, bool evict)
+{
+  for (uint32_t i = 0; i < pixels; i++)
+  {
+    uint32_t old = evict ? slot[i] : 0;
+    sums[i] += frame[i] - old;
+    slot[i] = frame[i];
+  }
+}
+
+
+static void frameAverageScalar(uint16_t * out, const uint32_t * sums, uint32_t pixels, uint16_t count)
+{
+  for (uint32_t i = 0; i < pixels; i++) out[i] = sums[i] / count;
+}
+
+
+//  frames are stride apart, out[] holds number pixels.
+static void frameMinScalar(uint16_t * out, const uint16_t * frames, uint16_t count, uint32_t number, uint32_t stride)
+{
+  memcpy(out, frames, number * sizeof(uint16_t));
+  for (uint16_t t = 1; t < count; t++)
+  {
+    const uint16_t * f = frames + (size_t)t * stride;
+    for (uint32_t i = 0; i < number; i++)
+    {
+      if (f[i] < out[i]) out[i] = f[i];
+    }
+  }
+}
+
+
+static void frameMaxScalar(uint16_t * out, const uint16_t * frames, uint16_t count, uint32_t number, uint32_t stride)
+{
+  memcpy(out, frames, number * sizeof(uint16_t));
+  for (uint16_t t = 1; t < count; t++)
+  {
+    const uint16_t * f = frames + (size_t)t * stride;
+    for (uint32_t i = 0; i < number; i++)
+    {
+      if (f[i] > out[i]) out[i] = f[i];
+    }
+  }
+}
+
+
+//  division by the same 16 bit count for every pixel, done as a multiply.
+//  Granlund & Montgomery, q = (t + ((n - t) >> shift1)) >> shift2
+//  with t = mulhi(n, m), exact for all 32 bit n.
+struct RA_Divider
+{
+  uint32_t m;
+  uint8_t  shift1;
+  uint8_t  shift2;
+};
+
+
+static RA_Divider divider(uint16_t d)
+{
+  uint8_t l = 0;
+  while ((1UL << l) < d) l++;
+  RA_Divider div;
+  div.m = (uint32_t)((((uint64_t)((1UL << l) - d)) << 32) / d + 1);
+  div.shift1 = (l > 0) ? 1 : 0;
+  div.shift2 = (l > 0) ? l - 1 : 0;
+  return div;
+}
+
+
+#ifdef RA_X86_SIMD
+
+///////////////////////////////////////////////////////////////
+//
+//  SSE2 - 8 samples per step
+//
+//  32 bit lanes cannot overflow as number <= 65535.
+__attribute__((target("sse2")))
+static uint32_t sumSSE2(const uint16_t * values, uint16_t number)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc = zero;
+  uint16_t i = 0;
+  for (; (uint32_t)i + 8 <= number; i += 8)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+    acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+    acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+  }
+  uint32_t lane[4];
+  _mm_storeu_si128((__m128i *)lane, acc);
+  uint32_t sum = lane[0] + lane[1] + lane[2] + lane[3];
+  return sum + sumScalar(values + i, number - i);
+}
+
+
+//  _mm_mul_epu32 multiplies the even 32 bit lanes into 64 bit lanes.
+__attribute__((target("sse2")))
+static uint64_t sumSquaresSSE2(const uint16_t * values, uint16_t number)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc = zero;
+  uint16_t i = 0;
+  for (; (uint32_t)i + 8 <= number; i += 8)
+  {
+    __m128i v  = _mm_loadu_si128((const __m128i *)(values + i));
+    __m128i lo = _mm_unpacklo_epi16(v, zero);
+    __m128i hi = _mm_unpackhi_epi16(v, zero);
+    __m128i lo1 = _mm_srli_epi64(lo, 32);
+    __m128i hi1 = _mm_srli_epi64(hi, 32);
+    acc = _mm_add_epi64(acc, _mm_mul_epu32(lo, lo));
+    acc = _mm_add_epi64(acc, _mm_mul_epu32(lo1, lo1));
+    acc = _mm_add_epi64(acc, _mm_mul_epu32(hi, hi));
+    acc = _mm_add_epi64(acc, _mm_mul_epu32(hi1, hi1));
+  }
+  uint64_t lane[2];
+  _mm_storeu_si128((__m128i *)lane, acc);
+  return lane[0] + lane[1] + sumSquaresScalar(values + i, number - i);
+}
+
+
+//  SSE2 has only signed 16 bit min / max, flipping the sign bit
+//  maps unsigned order onto signed order.
+__attribute__((target("sse2")))
+static uint16_t minSSE2(const uint16_t * values, uint16_t number)
+{
+  const __m128i bias = _mm_set1_epi16((short)0x8000);
+  __m128i acc = _mm_set1_epi16(0x7FFF);
+  uint16_t i = 0;
+  for (; (uint32_t)i + 8 <= number; i += 8)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+    acc = _mm_min_epi16(acc, _mm_xor_si128(v, bias));
+  }
+  uint16_t lane[8];
+  _mm_storeu_si128((__m128i *)lane, _mm_xor_si128(acc, bias));
+  uint16_t minimum = minScalar(lane, 8);
+  if (i < number)
+  {
+    uint16_t tail = minScalar(values + i, number - i);
+    if (tail < minimum) minimum = tail;
+  }
+  return minimum;
+}
+
+
+__attribute__((target("sse2")))
+static uint16_t maxSSE2(const uint16_t * values, uint16_t number)
+{
+  const __m128i bias = _mm_set1_epi16((short)0x8000);
+  __m128i acc = bias;
+  uint16_t i = 0;
+  for (; (uint32_t)i + 8 <= number; i += 8)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+    acc = _mm_max_epi16(acc, _mm_xor_si128(v, bias));
+  }
+  uint16_t lane[8];
+  _mm_storeu_si128((__m128i *)lane, _mm_xor_si128(acc, bias));
+  uint16_t maximum = maxScalar(lane, 8);
+  if (i < number)
+  {
+    uint16_t tail = maxScalar(values + i, number - i);
+    if (tail > maximum) maximum = tail;
+  }
+  return maximum;
+}
+
+
+__attribute__((target("sse2")))
+static void frameAddSSE2(uint32_t * sums, uint16_t * slot, const uint16_t * frame, uint32_t pixels, bool evict)
+{
+  const __m128i zero = _mm_setzero_si128();
+  uint32_t i = 0;
+  for (; i + 8 <= pixels; i += 8)
+  {
+    __m128i v  = _mm_loadu_si128((const __m128i *)(frame + i));
+    __m128i s0 = _mm_loadu_si128((const __m128i *)(sums + i));
+    __m128i s1 = _mm_loadu_si128((const __m128i *)(sums + i + 4));
+    s0 = _mm_add_epi32(s0, _mm_unpacklo_epi16(v, zero));
+    s1 = _mm_add_epi32(s1, _mm_unpackhi_epi16(v, zero));
+    if (evict)
+    {
+      __m128i o = _mm_loadu_si128((const __m128i *)(slot + i));
+      s0 = _mm_sub_epi32(s0, _mm_unpacklo_epi16(o, zero));
+      s1 = _mm_sub_epi32(s1, _mm_unpackhi_epi16(o, zero));
+    }
+    _mm_storeu_si128((__m128i *)(sums + i), s0);
+    _mm_storeu_si128((__m128i *)(sums + i + 4), s1);
+    _mm_storeu_si128((__m128i *)(slot + i), v);
+  }
+  frameAddScalar(sums + i, slot + i, frame + i, pixels - i, evict);
+}
+
+
+//  high 32 bits of n * m per lane, the odd lanes are shifted down first.
+__attribute__((target("sse2")))
+static inline __m128i mulhiSSE2(__m128i n, __m128i m)
+{
+  __m128i even = _mm_srli_epi64(_mm_mul_epu32(n, m), 32);
+  __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(n, 32), m);
+  return _mm_or_si128(even, _mm_and_si128(odd, _mm_set_epi32(-1, 0, -1, 0)));
+}
+
+
+//  _mm_packs_epi32 saturates signed, so pack q - 32768 and flip the sign bit back.
+__attribute__((target("sse2")))
+static void frameAverageSSE2(uint16_t * out, const uint32_t * sums, uint32_t pixels, uint16_t count)
+{
+  RA_Divider div = divider(count);
+  const __m128i m      = _mm_set1_epi32((int)div.m);
+  const __m128i shift1 = _mm_cvtsi32_si128(div.shift1);
+  const __m128i shift2 = _mm_cvtsi32_si128(div.shift2);
+  const __m128i bias32 = _mm_set1_epi32(0x8000);
+  const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+  uint32_t i = 0;
+  for (; i + 8 <= pixels; i += 8)
+  {
+    __m128i n0 = _mm_loadu_si128((const __m128i *)(sums + i));
+    __m128i n1 = _mm_loadu_si128((const __m128i *)(sums + i + 4));
+    __m128i t0 = mulhiSSE2(n0, m);
+    __m128i t1 = mulhiSSE2(n1, m);
+    __m128i q0 = _mm_srl_epi32(_mm_add_epi32(t0, _mm_srl_epi32(_mm_sub_epi32(n0, t0), shift1)), shift2);
+    __m128i q1 = _mm_srl_epi32(_mm_add_epi32(t1, _mm_srl_epi32(_mm_sub_epi32(n1, t1), shift1)), shift2);
+    __m128i q  = _mm_packs_epi32(_mm_sub_epi32(q0, bias32), _mm_sub_epi32(q1, bias32));
+    _mm_storeu_si128((__m128i *)(out + i), _mm_xor_si128(q, bias16));
+  }
+  frameAverageScalar(out + i, sums + i, pixels - i, count);
+}
+
+
+__attribute__((target("sse2")))
+static void frameMinSSE2(uint16_t * out, const uint16_t * frames, uint16_t count, uint32_t number, uint32_t stride)
+{
+  const __m128i bias = _mm_set1_epi16((short)0x8000);
+  memcpy(out, frames, number * sizeof(uint16_t));
+  for (uint16_t t = 1; t < count; t++)
+  {
+    const uint16_t * f = frames + (size_t)t * stride;
+    uint32_t i = 0;
+    for (; i + 8 <= number; i += 8)
+    {
+      __m128i a = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(out + i)), bias);
+      __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(f + i)), bias);
+      _mm_storeu_si128((__m128i *)(out + i), _mm_xor_si128(_mm_min_epi16(a, b), bias));
+    }
+    for (; i < number; i++)
+    {
+      if (f[i] < out[i]) out[i] = f[i];
+    }
+  }
+}
+
+
+__attribute__((target("sse2")))
+static void frameMaxSSE2(uint16_t * out, const uint16_t * frames, uint16_t count, uint32_t number, uint32_t stride)
+{
+  const __m128i bias = _mm_set1_epi16((short)0x8000);
+  memcpy(out, frames, number * sizeof(uint16_t));
+  for (uint16_t t = 1; t < count; t++)
+  {
+    const uint16_t * f = frames + (size_t)t * stride;
+    uint32_t i = 0;
+    for (; i + 8 <= number; i += 8)
+    {
+      __m128i a = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(out + i)), bias);
+      __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(f + i)), bias);
+      _mm_storeu_si128((__m128i *)(out + i), _mm_xor_si128(_mm_max_epi16(a, b), bias));
+    }
+    for (; i < number; i++)
+    {
+      if (f[i] > out[i]) out[i] = f[i];
+    }
+  }
+}
+
+
+///////////////////////////////////////////////////////////////
+//
+//  AVX2 - 16 samples per step
+//
+__attribute__((target("avx2")))
+static uint32_t sumAVX2(const uint16_t * values, uint16_t number)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i acc = zero;
+  uint16_t i = 0;
+  for (; (uint32_t)i + 16 <= number; i += 16)
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+    acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(v, zero));
+    acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(v, zero));
+  }
+  uint32_t lane[8];
+  _mm256_storeu_si256((__m256i *)lane, acc);
+  uint32_t sum = 0;
+  for (uint8_t k = 0; k < 8; k++) sum += lane[k];
+  return sum + sumScalar(values + i, number - i);
+}
+
+
+__attribute__((target("avx2")))
+static uint64_t sumSquaresAVX2(const uint16_t * values, uint16_t number)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i acc = zero;
+  uint16_t i = 0;
+  for (; (uint32_t)i + 16 <= number; i += 16)
+  {
+    __m256i v  = _mm256_loadu_si256((const __m256i *)(values + i));
+    __m256i lo = _mm256_unpacklo_epi16(v, zero);
+    __m256i hi = _mm256_unpackhi_epi16(v, zero);
+    __m256i lo1 = _mm256_srli_epi64(lo, 32);
+    __m256i hi1 = _mm256_srli_epi64(hi, 32);
+    acc = _mm256_add_epi64(acc, _mm256_mul_epu32(lo, lo));
+    acc = _mm256_add_epi64(acc, _mm256_mul_epu32(lo1, lo1));
+    acc = _mm256_add_epi64(acc, _mm256_mul_epu32(hi, hi));
+    acc = _mm256_add_epi64(acc, _mm256_mul_epu32(hi1, hi1));
+  }
+  uint64_t lane[4];
+  _mm256_storeu_si256((__m256i *)lane, acc);
+  return lane[0] + lane[1] + lane[2] + lane[3] + sumSquaresScalar(values + i, number - i);
+}
+
+
+__attribute__((target("avx2")))
+static uint16_t minAVX2(const uint16_t * values, uint16_t number)
+{
+  __m256i acc = _mm256_set1_epi16((short)0xFFFF);
+  uint16_t i = 0;
+  for (; (uint32_t)i + 16 <= number; i += 16)
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+    acc = _mm256_min_epu16(acc, v);
+  }
+  uint16_t lane[16];
+  _mm256_storeu_si256((__m256i *)lane, acc);
+  uint16_t minimum = minScalar(lane, 16);
+  if (i < number)
+  {
+    uint16_t tail = minScalar(values + i, number - i);
+    if (tail < minimum) minimum = tail;
+  }
+  return minimum;
+}
+
+
+__attribute__((target("avx2")))
+static uint16_t maxAVX2(const uint16_t * values, uint16_t number)
+{
+  __m256i acc = _mm256_setzero_si256();
+  uint16_t i = 0;
+  for (; (uint32_t)i + 16 <= number; i += 16)
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+    acc = _mm256_max_epu16(acc, v);
+  }
+  uint16_t lane[16];
+  _mm256_storeu_si256((__m256i *)lane, acc);
+  uint16_t maximum = maxScalar(lane, 16);
+  if (i < number)
+  {
+    uint16_t tail = maxScalar(values + i, number - i);
+    if (tail > maximum) maximum = tail;
+  }
+  return maximum;
+}
+
+
+//  _mm256_cvtepu16_epi32 keeps the pixel order, unpack would interleave the 128 bit halves.
+__attribute__((target("avx2")))
+static void frameAddAVX2(uint32_t * sums, uint16_t * slot, const uint16_t * frame, uint32_t pixels, bool evict)
+{
+  uint32_t i = 0;
+  for (; i + 16 <= pixels; i += 16)
+  {
+    __m256i v  = _mm256_loadu_si256((const __m256i *)(frame + i));
+    __m256i s0 = _mm256_loadu_si256((const __m256i *)(sums + i));
+    __m256i s1 = _mm256_loadu_si256((const __m256i *)(sums + i + 8));
+    s0 = _mm256_add_epi32(s0, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v)));
+    s1 = _mm256_add_epi32(s1, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1)));
+    if (evict)
+    {
+      __m256i o = _mm256_loadu_si256((const __m256i *)(slot + i));
+      s0 = _mm256_sub_epi32(s0, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(o)));
+      s1 = _mm256_sub_epi32(s1, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(o, 1)));
+    }
+    _mm256_storeu_si256((__m256i *)(sums + i), s0);
+    _mm256_storeu_si256((__m256i *)(sums + i + 8), s1);
+    _mm256_storeu_si256((__m256i *)(slot + i), v);
+  }
+  frameAddScalar(sums + i, slot + i, frame + i, pixels - i, evict);
+}
+
+
+__attribute__((target("avx2")))
+static inline __m256i mulhiAVX2(__m256i n, __m256i m)
+{
+  __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(n, m), 32);
+  __m256i odd  = _mm256_mul_epu32(_mm256_srli_epi64(n, 32), m);
+  return _mm256_or_si256(even, _mm256_and_si256(odd, _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0)));
+}
+
+
+//  _mm256_packus_epi32 packs per 128 bit half, the permute restores the order.
+__attribute__((target("avx2")))
+static void frameAverageAVX2(uint16_t * out, const uint32_t * sums, uint32_t pixels, uint16_t count)
+{
+  RA_Divider div = divider(count);
+  const __m256i m      = _mm256_set1_epi32((int)div.m);
+  const __m128i shift1 = _mm_cvtsi32_si128(div.shift1);
+  const __m128i shift2 = _mm_cvtsi32_si128(div.shift2);
+  uint32_t i = 0;
+  for (; i + 16 <= pixels; i += 16)
+  {
+    __m256i n0 = _mm256_loadu_si256((const __m256i *)(sums + i));
+    __m256i n1 = _mm256_loadu_si256((const __m256i *)(sums + i + 8));
+    __m256i t0 = mulhiAVX2(n0, m);
+    __m256i t1 = mulhiAVX2(n1, m);
+    __m256i q0 = _mm256_srl_epi32(_mm256_add_epi32(t0, _mm256_srl_epi32(_mm256_sub_epi32(n0, t0), shift1)), shift2);
+    __m256i q1 = _mm256_srl_epi32(_mm256_add_epi32(t1, _mm256_srl_epi32(_mm256_sub_epi32(n1, t1), shift1)), shift2);
+    __m256i q  = _mm256_permute4x64_epi64(_mm256_packus_epi32(q0, q1), 0xD8);
+    _mm256_storeu_si256((__m256i *)(out + i), q);
+  }
+  frameAverageScalar(out + i, sums + i, pixels - i, count);
+}
+
+
+__attribute__((target("avx2")))
+static void frameMinAVX2(uint16_t * out, const uint16_t * frames, uint16_t count, uint32_t number, uint32_t stride)
+{
+  memcpy(out, frames, number * sizeof(uint16_t));
+  for (uint16_t t = 1; t < count; t++)
+  {
+    const uint16_t * f = frames + (size_t)t * stride;
+    uint32_t i = 0;
+    for (; i + 16 <= number; i += 16)
+    {
+      __m256i a = _mm256_loadu_si256((const __m256i *)(out + i));
+      __m256i b = _mm256_loadu_si256((const __m256i *)(f + i));
+      _mm256_storeu_si256((__m256i *)(out + i), _mm256_min_epu16(a, b));
+    }
+    for (; i < number; i++)
+    {
+      if (f[i] < out[i]) out[i] = f[i];
+    }
+  }
+}
+
+
+__attribute__((target("avx2")))
+static void frameMaxAVX2(uint16_t * out, const uint16_t * frames, uint16_t count, uint32_t number, uint32_t stride)
+{
+  memcpy(out, frames, number * sizeof(uint16_t));
+  for (uint16_t t = 1; t < count; t++)
+  {
+    const uint16_t * f = frames + (size_t)t * stride;
+    uint32_t i = 0;
+    for (; i + 16 <= number; i += 16)
+    {
+      __m256i a = _mm256_loadu_si256((const __m256i *)(out + i));
+      __m256i b = _mm256_loadu_si256((const __m256i *)(f + i));
+      _mm256_storeu_si256((__m256i *)(out + i), _mm256_max_epu16(a, b));
+    }
+    for (; i < number; i++)
+    {
+      if (f[i] > out[i]) out[i] = f[i];
+    }
+  }
+}
+
+#endif  //  RA_X86_SIMD
+
+
+///////////////////////////////////////////////////////////////
+//
+//  DISPATCH
+//
+struct RA_Kernels
+{
+  uint8_t  level;
+  uint32_t (*sum)(const uint16_t *, uint16_t);
+  uint64_t (*sumSquares)(const uint16_t *, uint16_t);
+  uint16_t (*minimum)(const uint16_t *, uint16_t);
+  uint16_t (*maximum)(const uint16_t *, uint16_t);
+  void     (*frameAdd)(uint32_t *, uint16_t *, const uint16_t *, uint32_t, bool);
+  void     (*frameAverage)(uint16_t *, const uint32_t *, uint32_t, uint16_t);
+  void     (*frameMin)(uint16_t *, const uint16_t *, uint16_t, uint32_t, uint32_t);
+  void     (*frameMax)(uint16_t *, const uint16_t *, uint16_t, uint32_t, uint32_t);
+};
+
+
+static const RA_Kernels kernels[] =
+{
+  { RA_SIMD_SCALAR, sumScalar, sumSquaresScalar, minScalar, maxScalar,
+    frameAddScalar, frameAverageScalar, frameMinScalar, frameMaxScalar },
+#ifdef RA_X86_SIMD
+  { RA_SIMD_SSE2,   sumSSE2,   sumSquaresSSE2,   minSSE2,   maxSSE2,
+    frameAddSSE2,   frameAverageSSE2,   frameMinSSE2,   frameMaxSSE2 },
+  { RA_SIMD_AVX2,   sumAVX2,   sumSquaresAVX2,   minAVX2,   maxAVX2,
+    frameAddAVX2,   frameAverageAVX2,   frameMinAVX2,   frameMaxAVX2 },
+#endif
+};
+
+
+//  highest level the CPU supports.
+static uint8_t supported()
+{
+#ifdef RA_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return RA_SIMD_AVX2;
+  if (__builtin_cpu_supports("sse2")) return RA_SIMD_SSE2;
+#endif
+  return RA_SIMD_SCALAR;
+}
+
+
+//  constant initialized to the scalar table, so a kernel call from another
+//  static constructor works whatever the initialization order is.
+//  atomic where there is more than one table, ra_simdSelect() may change it
+//  while other threads call the kernels; every table gives the same results.
+#ifdef RA_X86_SIMD
+static std::atomic<const RA_Kernels *> active(&kernels[RA_SIMD_SCALAR]);
+#else
+static const RA_Kernels * active = &kernels[RA_SIMD_SCALAR];
+#endif
+
+
+//  the CPU is checked on the first call, once, thread safe (C++11 static).
+static bool detect()
+{
+  active = &kernels[supported()];
+  return true;
+}
+
+
+static const RA_Kernels * kernelsInUse()
+{
+  static bool detected = detect();
+  (void) detected;
+  return active;
+}
+
+
+uint32_t ra_sum(const uint16_t * values, uint16_t number)
+{
+  return kernelsInUse()->sum(values, number);
+}
+
+
+uint64_t ra_sumSquares(const uint16_t * values, uint16_t number)
+{
+  return kernelsInUse()->sumSquares(values, number);
+}
+
+
+uint16_t ra_min(const uint16_t * values, uint16_t number)
+{
+  return kernelsInUse()->minimum(values, number);
+}
+
+
+uint16_t ra_max(const uint16_t * values, uint16_t number)
+{
+  return kernelsInUse()->maximum(values, number);
+}
+
+
+void ra_frameAdd(uint32_t * sums, uint16_t * slot, const uint16_t * frame, uint32_t pixels, bool evict)
+{
+  kernelsInUse()->frameAdd(sums, slot, frame, pixels, evict);
+}
+
+
+void ra_frameAverage(uint16_t * out, const uint32_t * sums, uint32_t pixels, uint16_t count)
+{
+  kernelsInUse()->frameAverage(out, sums, pixels, count);
+}
+
+
+//  tiles keep out[] in L1 while count frames stream by.
+const uint32_t RA_FRAME_TILE = 2048;
+
+
+void ra_frameMin(uint16_t * out, const uint16_t * frames, uint16_t count, uint32_t pixels)
+{
+  for (uint32_t first = 0; first < pixels; first += RA_FRAME_TILE)
+  {
+    uint32_t number = pixels - first;
+    if (number > RA_FRAME_TILE) number = RA_FRAME_TILE;
+    kernelsInUse()->frameMin(out + first, frames + first, count, number, pixels);
+  }
+}
+
+
+void ra_frameMax(uint16_t * out, const uint16_t * frames, uint16_t count, uint32_t pixels)
+{
+  for (uint32_t first = 0; first < pixels; first += RA_FRAME_TILE)
+  {
+    uint32_t number = pixels - first;
+    if (number > RA_FRAME_TILE) number = RA_FRAME_TILE;
+    kernelsInUse()->frameMax(out + first, frames + first, count, number, pixels);
+  }
+}
+
+
+uint8_t ra_simdLevel()
+{
+  return kernelsInUse()->level;
+}
+
+
+uint8_t ra_simdSelect(uint8_t level)
+{
+  kernelsInUse();   //  the first call must not overrule this selection.
+  uint8_t top = supported();
+  if (level > top) level = top;
+  //  only the scalar table without RA_X86_SIMD, no write at all.
+  if (active != &kernels[level]) active = &kernels[level];
+  return level;
+}
+
+}  //  namespace runningaverage
+
+
+//  -- END OF FILE --
+
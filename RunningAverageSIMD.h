@@ -0,0 +1,96 @@
+#pragma once
+//
+//    FILE: RunningAverageSIMD.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: reduction kernels over uint16_t arrays for RunningAverage
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  On x86 / x86_64 (GCC, clang) the uint16_t kernels use SSE2 or AVX2,
+//  selected at runtime by CPUID. Other targets (AVR, ESP, ARM) use a scalar loop.
+//  The generic templates handle all other sample types.
+
+
+#include "Arduino.h"
+
+
+namespace runningaverage
+{
+
+const uint8_t RA_SIMD_SCALAR  = 0;
+const uint8_t RA_SIMD_SSE2    = 1;
+const uint8_t RA_SIMD_AVX2    = 2;
+
+
+//  uint16_t kernels, number <= 65535 so the sum always fits 32 bit.
+uint32_t ra_sum(const uint16_t * values, uint16_t number);
+uint64_t ra_sumSquares(const uint16_t * values, uint16_t number);
+uint16_t ra_min(const uint16_t * values, uint16_t number);  //  number > 0
+uint16_t ra_max(const uint16_t * values, uint16_t number);  //  number > 0
+
+//  frame kernels, one lane per pixel, frames are uint16_t[pixels].
+//  sums[i] += frame[i] - slot[i] if evict, else sums[i] += frame[i]; slot[] = frame[].
+void     ra_frameAdd(uint32_t * sums, uint16_t * slot, const uint16_t * frame, uint32_t pixels, bool evict);
+//  out[i] = sums[i] / count, exact, count > 0, the quotient must fit 16 bit.
+void     ra_frameAverage(uint16_t * out, const uint32_t * sums, uint32_t pixels, uint16_t count);
+//  out[i] = min / max over frames[0 .. count)[i], count > 0.
+void     ra_frameMin(uint16_t * out, const uint16_t * frames, uint16_t count, uint32_t pixels);
+void     ra_frameMax(uint16_t * out, const uint16_t * frames, uint16_t count, uint32_t pixels);
+
+//  returns the kernel set in use, the best one the CPU supports by default.
+uint8_t  ra_simdLevel();
+//  force a kernel set, e.g. to benchmark; clipped to what the CPU supports.
+//  returns the level selected. Thread safe, calls in progress finish with
+//  the previous set, all sets give the same results.
+uint8_t  ra_simdSelect(uint8_t level);
+
+
+//  generic versions for other sample types.
+template <typename T>
+uint64_t ra_sum(const T * values, uint16_t number)
+{
+  uint64_t sum = 0;
+  for (uint16_t i = 0; i < number; i++) sum += values[i];
+  return sum;
+}
+
+template <typename T>
+uint64_t ra_sumSquares(const T * values, uint16_t number)
+{
+  uint64_t sum = 0;
+  for (uint16_t i = 0; i < number; i++)
+  {
+    uint64_t x = values[i];
+    sum += x * x;
+  }
+  return sum;
+}
+
+template <typename T>
+T ra_min(const T * values, uint16_t number)
+{
+  T minimum = values[0];
+  for (uint16_t i = 1; i < number; i++)
+  {
+    if (values[i] < minimum) minimum = values[i];
+  }
+  return minimum;
+}
+
+template <typename T>
+T ra_max(const T * values, uint16_t number)
+{
+  T maximum = values[0];
+  for (uint16_t i = 1; i < number; i++)
+  {
+    if (values[i] > maximum) maximum = values[i];
+  }
+  return maximum;
+}
+
+}  //  namespace runningaverage
+
+
+//  -- END OF FILE --
+
@@ -0,0 +1,169 @@
+#pragma once
+//
+//    FILE: RunningAverageSnapshot.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: Arduino library to calculate the running average by means of a circular buffer
+//          seqlock published statistics for many concurrent readers.
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  The thread that adds values calls publish() after a batch.
+//  Any number of readers call read(), which never blocks the writer
+//  and never writes a shared cache line, it retries if a publish()
+//  overlapped the copy (seqlock).
+//
+//  On AVR there is no <atomic>, publish() and read() copy with interrupts
+//  disabled instead.
+
+
+#include "RunningAverage.h"
+
+#if !defined(__AVR__)
+#include <atomic>
+#else
+#include <util/atomic.h>
+#endif
+
+
+namespace runningaverage
+{
+
+template <typename T = uint16_t>
+struct RA_Snapshot
+{
+  T        average;   //  getFastAverage()
+  T        minimum;   //  getMinInBuffer()
+  T        maximum;   //  getMaxInBuffer()
+  uint16_t count;
+  float    stddev;    //  NAN if count < 2
+};
+
+
+template <typename T = uint16_t>
+class RunningAverageSnapshot
+{
+public:
+  RunningAverageSnapshot()
+  {
+    RA_Snapshot<T> empty;
+    memset(&empty, 0, sizeof(empty));
+    empty.stddev = NAN;
+    _sequence = 0;
+    _store(empty);
+  };
+
+  //  WRITER, one thread.
+  template <typename A, uint16_t F>
+  void     publish(const RunningAverage<T, A, F> & ra)
+  {
+    RA_Snapshot<T> snap;
+    memset(&snap, 0, sizeof(snap));
+    snap.average = ra.getFastAverage();
+    snap.minimum = ra.getMinInBuffer();
+    snap.maximum = ra.getMaxInBuffer();
+    snap.count   = ra.getCount();
+    snap.stddev  = ra.getStandardDeviation();
+    publish(snap);
+  };
+
+  void     publish(const RA_Snapshot<T> & snap)
+  {
+#if !defined(__AVR__)
+    //  odd sequence = write in progress
+    uint32_t seq = _sequence.load(std::memory_order_relaxed);
+    _sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _store(snap);
+    _sequence.store(seq + 2, std::memory_order_release);
+#else
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      _sequence = _sequence + 2;
+      _store(snap);
+    }
+#endif
+  };
+
+  //  READERS, any number of threads.
+  //  returns a consistent snapshot, retries while a publish() is in progress.
+  RA_Snapshot<T> read() const
+  {
+    RA_Snapshot<T> snap;
+    while (!tryRead(snap));
+    return snap;
+  };
+
+  //  one attempt, false if a publish() overlapped.
+  bool     tryRead(RA_Snapshot<T> & snap) const
+  {
+#if !defined(__AVR__)
+    uint32_t before = _sequence.load(std::memory_order_acquire);
+    if (before & 1) return false;
+    _load(snap);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint32_t after = _sequence.load(std::memory_order_relaxed);
+    return before == after;
+#else
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      _load(snap);
+    }
+    return true;
+#endif
+  };
+
+  //  even number, incremented by 2 per publish().
+  uint32_t getVersion() const
+  {
+#if !defined(__AVR__)
+    return _sequence.load(std::memory_order_acquire) & ~1UL;
+#else
+    uint32_t seq;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { seq = _sequence; }
+    return seq;
+#endif
+  };
+
+
+protected:
+  //  the snapshot is copied as 32 bit words, relaxed atomics so
+  //  a torn copy is detected by the sequence, not a data race.
+  static const uint8_t _WORDS = (sizeof(RA_Snapshot<T>) + 3) / 4;
+
+#if !defined(__AVR__)
+  std::atomic<uint32_t> _sequence;
+  std::atomic<uint32_t> _data[_WORDS];
+
+  void     _store(const RA_Snapshot<T> & snap)
+  {
+    uint32_t words[_WORDS] = { 0 };
+    memcpy(words, &snap, sizeof(snap));
+    for (uint8_t i = 0; i < _WORDS; i++) _data[i].store(words[i], std::memory_order_relaxed);
+  };
+  void     _load(RA_Snapshot<T> & snap) const
+  {
+    uint32_t words[_WORDS];
+    for (uint8_t i = 0; i < _WORDS; i++) words[i] = _data[i].load(std::memory_order_relaxed);
+    memcpy(&snap, words, sizeof(snap));
+  };
+#else
+  volatile uint32_t _sequence;
+  RA_Snapshot<T>    _data;
+
+  void     _store(const RA_Snapshot<T> & snap) { _data = snap; };
+  void     _load(RA_Snapshot<T> & snap) const  { snap = _data; };
+#endif
+};
+
+}  //  namespace runningaverage
+
+
+#if !defined(RA_NO_GLOBAL_NAMES)
+template <typename T = uint16_t>
+using RunningAverageSnapshot = runningaverage::RunningAverageSnapshot<T>;
+#endif
+
+
+//  -- END OF FILE --
+
@@ -0,0 +1,315 @@
+#pragma once
+//
+//    FILE: RunningAverageStatic.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: Arduino library to calculate the running average by means of a circular buffer
+//          fixed size variant, no dynamic memory.
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  Same interface as RunningAverage, the buffer of N elements is part of the object.
+//  If N is a power of two and all N elements are used, the index wraps with
+//  MASK and a full buffer divides by SHIFT, both follow from N at compile time.
+//  A partial size wraps by compare, like RunningAverage.
+
+
+#include "RunningAverage.h"
+
+
+namespace runningaverage
+{
+
+//  floor(log2(n)), constexpr for the compile time window math.
+constexpr uint8_t ra_log2(const uint16_t n)
+{
+  return (n <= 1) ? 0 : 1 + ra_log2(n >> 1);
+}
+
+
+template <uint16_t N, typename T = uint16_t, typename A = uint32_t>
+class RunningAverageStatic
+{
+public:
+  static_assert(N > 0, "RunningAverageStatic needs at least one element");
+
+  static constexpr bool     POW2  = (N & (N - 1)) == 0;
+  static constexpr uint8_t  SHIFT = ra_log2(N);
+  static constexpr uint16_t MASK  = N - 1;
+
+  RunningAverageStatic()
+  {
+    _partial = N;
+    clear();
+  };
+
+  void     clear()
+  {
+    _count = 0;
+    _index = 0;
+    _sum = 0;
+    _min = 0;
+    _max = 0;
+    for (uint16_t i = N; i > 0; )
+    {
+      _array[--i] = 0;  //  keeps addValue simpler
+    }
+  };
+
+  void     add(const T value)    { addValue(value); };
+
+  //  no null check, no wrap compare for power of two sizes.
+  void     addValue(const T value)
+  {
+    _sum -= _array[_index];
+    _array[_index] = value;
+    _sum += value;
+    if (POW2 && (_partial == N))
+    {
+      _index = (_index + 1) & MASK;
+    }
+    else
+    {
+      _index++;
+      if (_index == _partial) _index = 0;
+    }
+
+    //  handle min max
+    _min = ((_count == 0) || (value < _min)) ? value : _min;
+    _max = ((_count == 0) || (value > _max)) ? value : _max;
+
+    _count += (_count < _partial);
+  };
+
+  void     fillValue(const T value, const uint16_t number)
+  {
+    clear();
+    uint16_t s = number;
+    if (s > _partial) s = _partial;
+
+    for (uint16_t i = s; i > 0; i--)
+    {
+      addValue(value);
+    }
+  };
+
+  T        getValue(const uint16_t position) const
+  {
+    if (position >= _count) return 0;
+    uint16_t _pos = position + _index;
+    if (_pos >= _count) _pos -= _count;
+    return _array[_pos];
+  };
+
+  T        getAverage() const
+  {
+    if (_count == 0) return 0;
+    A sum = 0;
+    for (uint16_t i = 0; i < _count; i++)
+    {
+      sum += _array[i];
+    }
+    return sum / _count;
+  };
+
+  T        getFastAverage() const
+  {
+    if (_count == 0) return 0;
+    if (POW2 && (_count == N)) return _sum >> SHIFT;
+    return _sum / _count;
+  };
+
+  //  return statistical characteristics of the running average
+  float    getStandardDeviation() const
+  {
+    if (_count <= 1) return NAN;
+
+    float temp = 0;
+    float average = (float)_sum / _count;
+    for (uint16_t i = 0; i < _count; i++)
+    {
+      float diff = _array[i] - average;
+      temp += diff * diff;
+    }
+    return sqrt(temp / (_count - 1));
+  };
+
+  float    getStandardError() const
+  {
+    float temp = getStandardDeviation();
+    if (isnan(temp)) return NAN;
+    float n = (_count >= 30) ? _count : _count - 1;
+    return temp / sqrt(n);
+  };
+
+  //  returns min/max added to the data-set since last clear
+  T        getMin() const { return _min; };
+  T        getMax() const { return _max; };
+
+  //  returns min/max from the values in the internal buffer
+  T        getMinInBuffer() const
+  {
+    if (_count == 0) return 0;
+    T minimum = _array[0];
+    for (uint16_t i = 1; i < _count; i++)
+    {
+      if (_array[i] < minimum) minimum = _array[i];
+    }
+    return minimum;
+  };
+
+  T        getMaxInBuffer() const
+  {
+    if (_count == 0) return 0;
+    T maximum = _array[0];
+    for (uint16_t i = 1; i < _count; i++)
+    {
+      if (_array[i] > maximum) maximum = _array[i];
+    }
+    return maximum;
+  };
+
+  //  return true if buffer is full
+  bool     bufferIsFull() const { return _count == _partial; };
+
+  T        getElement(uint16_t index) const
+  {
+    if (index >= _count) return 0;
+    return _array[index];
+  };
+
+  constexpr uint16_t getSize() const { return N; }
+  uint16_t getCount() const { return _count; }
+  A        getSum() const { return _sum; }
+
+  //  use not all elements just a part from 0..partial-1
+  //  (re)setting partial keeps the newest min(partial, count) values, O(N).
+  void     setPartial(const uint16_t partial = 0)
+  {
+    uint16_t p = partial;
+    if ((p == 0) || (p > N)) p = N;
+
+    //  newest n values to _array[0 .. n), oldest first, rest zero.
+    uint16_t n = (_count < p) ? _count : p;
+    if (_count > 0)
+    {
+      uint16_t first = _index + _count - n;
+      if (first >= _count) first -= _count;
+      ra_rotate(_array, _count, first);
+    }
+    _sum = 0;
+    for (uint16_t i = 0; i < N; i++)
+    {
+      if (i >= n) _array[i] = 0;
+      _sum += _array[i];
+    }
+
+    _partial = p;
+    _count = n;
+    _index = (n == _partial) ? 0 : n;
+  };
+  uint16_t getPartial() const { return _partial; };
+
+
+  //  get some stats from the last count additions.
+  T        getAverageLast(uint16_t count) const
+  {
+    uint16_t cnt = count;
+    if (cnt > _count) cnt = _count;
+    if (cnt == 0) return 0;
+
+    uint16_t idx = _index;
+    A sum = 0;
+    for (uint16_t i = 0; i < cnt; i++)
+    {
+      idx = _prev(idx);
+      sum += _array[idx];
+    }
+    return sum / cnt;
+  };
+
+  T        getMinInBufferLast(uint16_t count) const
+  {
+    uint16_t cnt = count;
+    if (cnt > _count) cnt = _count;
+    if (cnt == 0) return 0;
+
+    uint16_t idx = _prev(_index);
+    T minimum = _array[idx];
+    for (uint16_t i = 1; i < cnt; i++)
+    {
+      idx = _prev(idx);
+      if (_array[idx] < minimum) minimum = _array[idx];
+    }
+    return minimum;
+  };
+
+  T        getMaxInBufferLast(uint16_t count) const
+  {
+    uint16_t cnt = count;
+    if (cnt > _count) cnt = _count;
+    if (cnt == 0) return 0;
+
+    uint16_t idx = _prev(_index);
+    T maximum = _array[idx];
+    for (uint16_t i = 1; i < cnt; i++)
+    {
+      idx = _prev(idx);
+      if (_array[idx] > maximum) maximum = _array[idx];
+    }
+    return maximum;
+  };
+
+  float    getAverageSubset(uint16_t start, uint16_t count) const
+  {
+    if (start >= _count) return NAN;
+
+    uint16_t cnt = _count - start;
+    if (cnt > count) cnt = count;
+    if (cnt == 0) return NAN;
+
+    A sum = 0;
+    for (uint16_t i = 0; i < cnt; i++)
+    {
+      sum += _array[_slot(start + i)];
+    }
+    return (float)sum / cnt;
+  };
+
+
+protected:
+  uint16_t _count;
+  uint16_t _index;
+  uint16_t _partial;
+  A        _sum;
+  T        _min;
+  T        _max;
+  T        _array[N];
+
+  uint16_t _prev(const uint16_t idx) const
+  {
+    if (POW2 && (_partial == N)) return (idx - 1) & MASK;
+    return (idx == 0) ? _partial - 1 : idx - 1;
+  };
+
+  //  array index of position, 0 = oldest, same mapping as RunningAverage.
+  uint16_t _slot(const uint16_t position) const
+  {
+    uint32_t idx = (uint32_t)_index + _partial - _count + position;
+    while (idx >= _partial) idx -= _partial;
+    return idx;
+  };
+};
+
+}  //  namespace runningaverage
+
+
+#if !defined(RA_NO_GLOBAL_NAMES)
+//  global name, mirrors the RunningAverage typedef
+template <uint16_t N, typename T = uint16_t, typename A = uint32_t>
+using RunningAverageStatic = runningaverage::RunningAverageStatic<N, T, A>;
+#endif
+
+
+//  -- END OF FILE --
+
@@ -0,0 +1,267 @@
+#pragma once
+//
+//    FILE: RunningAverageTimed.h
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.5.0
+//    DATE: 2026-10-16
+// PURPOSE: Arduino library to calculate the running average by means of a circular buffer
+//          time based window, e.g. the average of the last 5 seconds.
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  Stores (timestamp, value) pairs, samples older than window are evicted
+//  by addValue(), evict() and the getters. Sum and min / max (monotonic deques)
+//  are incremental so a sample costs O(1) amortized.
+//  If a burst fills the ring with samples that did not expire yet, the ring
+//  doubles its capacity; if that fails the oldest sample is dropped.
+//
+//  TS = uint16_t stores 16 bit timestamps, ages are computed modulo 65536.
+//  This is exact as long as window <= 32767, which is enforced.
+
+
+#include "RunningAverage.h"
+
+
+namespace runningaverage
+{
+
+template <typename T = uint16_t, typename A = uint32_t, typename TS = uint32_t>
+class RunningAverageTimed
+{
+public:
+  //  capacity = initial number of samples, window in clock units, default millis().
+  RunningAverageTimed(const uint16_t capacity, const uint32_t window)
+  {
+    _capacity = 0;
+    _values = NULL;
+    _stamps = NULL;
+    _deques = NULL;
+    _clock = _millis;
+    _overflow = 0;
+    setWindow(window);
+    _allocate(capacity);
+    clear();
+  };
+
+  ~RunningAverageTimed() { _release(); };
+
+  //  owns raw buffers, not copyable.
+  RunningAverageTimed(const RunningAverageTimed &) = delete;
+  RunningAverageTimed & operator = (const RunningAverageTimed &) = delete;
+
+  void     clear()
+  {
+    _count = 0;
+    _head = 0;
+    _sum = 0;
+    _minDeque.clear();
+    _maxDeque.clear();
+  };
+
+  //  e.g. micros() or a test clock.
+  void     setClock(uint32_t (* clock)(void)) { _clock = (clock == NULL) ? _millis : clock; };
+  void     setWindow(const uint32_t window)
+  {
+    _window = window;
+    if ((sizeof(TS) == 2) && (_window > 32767)) _window = 32767;
+  };
+  uint32_t getWindow() const    { return _window; };
+
+  void     add(const T value)   { addValue(value); };
+  void     addValue(const T value) { addValue(value, _clock()); };
+  void     addValue(const T value, const uint32_t now);
+
+  //  removes the samples older than window, returns the number removed.
+  uint16_t evict()              { return evict(_clock()); };
+  uint16_t evict(const uint32_t now);
+
+  //  the getters evict first.
+  T        getAverage();         //  iterates over all elements.
+  T        getFastAverage()     { evict(); return (_count == 0) ? 0 : _sum / _count; };
+  A        getSum()             { evict(); return _sum; };
+  uint16_t getCount()           { evict(); return _count; };
+  T        getMinInBuffer()     { evict(); return (_count == 0) ? 0 : _values[_minDeque.front()]; };
+  T        getMaxInBuffer()     { evict(); return (_count == 0) ? 0 : _values[_maxDeque.front()]; };
+
+  //  position 0 is the oldest, no eviction.
+  T        getValue(const uint16_t position) const
+  {
+    return (position < _count) ? _values[_slot(position)] : 0;
+  };
+  TS       getTimestamp(const uint16_t position) const
+  {
+    return (position < _count) ? _stamps[_slot(position)] : 0;
+  };
+
+  uint16_t getCapacity() const  { return _capacity; };
+  //  samples dropped because the ring could not grow.
+  uint32_t getOverflow() const  { return _overflow; };
+
+
+protected:
+  uint16_t _capacity;
+  uint16_t _count;
+  uint16_t _head;     //  oldest
+  uint32_t _window;
+  uint32_t _newest;   //  timestamp of the last sample, full 32 bit
+  A        _sum;
+  uint32_t _overflow;
+  T *      _values;
+  TS *     _stamps;
+  uint16_t * _deques;
+  RA_Deque _minDeque;
+  RA_Deque _maxDeque;
+  uint32_t (* _clock)(void);
+
+  static uint32_t _millis()    { return millis(); };
+
+  uint16_t _slot(const uint16_t position) const
+  {
+    uint32_t s = (uint32_t)_head + position;
+    if (s >= _capacity) s -= _capacity;
+    return s;
+  };
+
+  void     _popOldest()
+  {
+    if (_minDeque.front() == _head) _minDeque.popFront();
+    if (_maxDeque.front() == _head) _maxDeque.popFront();
+    _sum -= _values[_head];
+    _head = _slot(1);
+    _count--;
+  };
+
+  bool     _allocate(uint16_t capacity);
+  void     _release()
+  {
+    if (_values != NULL) free(_values);
+    if (_stamps != NULL) free(_stamps);
+    if (_deques != NULL) free(_deques);
+    _values = NULL;
+    _stamps = NULL;
+    _deques = NULL;
+  };
+};
+
+
+///////////////////////////////////////////////////////////////
+//
+//  IMPLEMENTATION
+//
+template <typename T, typename A, typename TS>
+void RunningAverageTimed<T, A, TS>::addValue(const T value, const uint32_t now)
+{
+  evict(now);
+  if (_count == _capacity)
+  {
+    //  burst, grow, else drop the oldest.
+    uint32_t larger = 2UL * _capacity;
+    if (larger > 65535) larger = 65535;
+    if ((larger == _capacity) || !_allocate(larger))
+    {
+      if (_count == 0) return;
+      _popOldest();
+      _overflow++;
+    }
+  }
+
+  uint16_t idx = _slot(_count);
+  while (!_minDeque.empty() && (_values[_minDeque.back()] >= value)) _minDeque.popBack();
+  while (!_maxDeque.empty() && (_values[_maxDeque.back()] <= value)) _maxDeque.popBack();
+  _minDeque.pushBack(idx);
+  _maxDeque.pushBack(idx);
+
+  _values[idx] = value;
+  _stamps[idx] = (TS)now;
+  _sum += value;
+  _newest = now;
+  _count++;
+}
+
+
+template <typename T, typename A, typename TS>
+uint16_t RunningAverageTimed<T, A, TS>::evict(const uint32_t now)
+{
+  uint16_t removed = _count;
+  //  all expired, also keeps 16 bit ages unambiguous.
+  if ((_count > 0) && ((uint32_t)(now - _newest) >= _window))
+  {
+    clear();
+    return removed;
+  }
+  while (_count > 0)
+  {
+    TS age = (TS)((TS)now - _stamps[_head]);
+    if (age < _window) break;
+    _popOldest();
+  }
+  return removed - _count;
+}
+
+
+template <typename T, typename A, typename TS>
+T RunningAverageTimed<T, A, TS>::getAverage()
+{
+  evict();
+  if (_count == 0) return 0;
+  //  at most two contiguous runs
+  uint16_t first = _capacity - _head;
+  if (first > _count) first = _count;
+  A sum = ra_sum(_values + _head, first);
+  sum += ra_sum(_values, _count - first);
+  return sum / _count;
+}
+
+
+//  (re)allocates the ring, the samples are moved to the start
+//  and the deques are rebuilt, O(count).
+template <typename T, typename A, typename TS>
+bool RunningAverageTimed<T, A, TS>::_allocate(uint16_t capacity)
+{
+  if (capacity == 0) return false;
+  T *  values = (T *) malloc(capacity * sizeof(T));
+  TS * stamps = (TS *) malloc(capacity * sizeof(TS));
+  uint16_t * deques = (uint16_t *) malloc(2UL * capacity * sizeof(uint16_t));
+  if ((values == NULL) || (stamps == NULL) || (deques == NULL))
+  {
+    if (values != NULL) free(values);
+    if (stamps != NULL) free(stamps);
+    if (deques != NULL) free(deques);
+    return false;
+  }
+
+  uint16_t count = (_values == NULL) ? 0 : _count;
+  for (uint16_t i = 0; i < count; i++)
+  {
+    values[i] = _values[_slot(i)];
+    stamps[i] = _stamps[_slot(i)];
+  }
+  _release();
+  _values = values;
+  _stamps = stamps;
+  _deques = deques;
+  _capacity = capacity;
+  _head = 0;
+
+  _minDeque.begin(_deques, _capacity);
+  _maxDeque.begin(_deques + _capacity, _capacity);
+  for (uint16_t i = 0; i < count; i++)
+  {
+    while (!_minDeque.empty() && (_values[_minDeque.back()] >= _values[i])) _minDeque.popBack();
+    while (!_maxDeque.empty() && (_values[_maxDeque.back()] <= _values[i])) _maxDeque.popBack();
+    _minDeque.pushBack(i);
+    _maxDeque.pushBack(i);
+  }
+  return true;
+}
+
+}  //  namespace runningaverage
+
+
+#if !defined(RA_NO_GLOBAL_NAMES)
+template <typename T = uint16_t, typename A = uint32_t, typename TS = uint32_t>
+using RunningAverageTimed = runningaverage::RunningAverageTimed<T, A, TS>;
+#endif
+
+
+//  -- END OF FILE --
+
@@ -0,0 +1,94 @@
+//
+//    FILE: ra_bank.ino
+//  AUTHOR: Rob Tillaart
+//    DATE: 2026-10-16
+// PURPOSE: RunningAverageBank versus one RunningAverage object per channel.
+//          bank wide readout with getFastAverages().
+//     URL: https://github.com/RobTillaart/RunningAverage
+//
+//  needs a board with enough RAM for CHANNELS * (SIZE + 8) * 2 bytes
+//  plus the RunningAverage objects.
+
+
+#include "RunningAverageBank.h"
+
+
+#if defined(__AVR__)
+const uint16_t CHANNELS = 20;
+#else
+const uint16_t CHANNELS = 5000;
+#endif
+const uint16_t SIZE = 16;
+
+RunningAverageBank<> bank(CHANNELS, SIZE);
+RunningAverage * single[CHANNELS];
+uint16_t averages[CHANNELS];
+
+uint32_t start, stop;
+volatile uint16_t x;
+
+
+void setup(void)
+{
+  Serial.begin(115200);
+  Serial.println();
+  Serial.println(__FILE__);
+  Serial.print("RUNNINGAVERAGE_LIB_VERSION: ");
+  Serial.println(RUNNINGAVERAGE_LIB_VERSION);
+  Serial.println();
+
+  if (bank.getChannels() != CHANNELS)
+  {
+    Serial.println("not enough memory");
+    return;
+  }
+  for (uint16_t c = 0; c < CHANNELS; c++)
+  {
+    single[c] = new RunningAverage(SIZE);
+  }
+
+  for (uint16_t s = 0; s < SIZE; s++)
+  {
+    for (uint16_t c = 0; c < CHANNELS; c++)
+    {
+      uint16_t value = random(4096);
+      bank.addValue(c, value);
+      single[c]->addValue(value);
+    }
+  }
+
+  start = micros();
+  for (uint16_t c = 0; c < CHANNELS; c++) single[c]->addValue(c);
+  stop = micros();
+  Serial.print("addValue objects:\t");
+  Serial.println(stop - start);
+
+  start = micros();
+  for (uint16_t c = 0; c < CHANNELS; c++) bank.addValue(c, c);
+  stop = micros();
+  Serial.print("addValue bank:\t\t");
+  Serial.println(stop - start);
+
+  start = micros();
+  for (uint16_t c = 0; c < CHANNELS; c++) averages[c] = single[c]->getFastAverage();
+  stop = micros();
+  Serial.print("readout objects:\t");
+  Serial.println(stop - start);
+
+  start = micros();
+  bank.getFastAverages(averages);
+  stop = micros();
+  Serial.print("readout bank:\t\t");
+  Serial.println(stop - start);
+  x = averages[CHANNELS - 1];
+
+  Serial.println("\ndone...\n");
+}
+
+
+void loop(void)
+{
+}
+
+
+//  -- END OF FILE --
@@ -0,0 +1,60 @@
+//
+//    FILE: ra_cascade.ino
+//  AUTHOR: Rob Tillaart
+//    DATE: 2026-10-16
+// PURPOSE: last minute, hour and day with a RunningAverageCascade
+//          instead of chaining RunningAverage objects by hand (see ra_hour).
+//     URL: https://github.com/RobTillaart/RunningAverage
+
+
+#include "RunningAverageCascade.h"
+
+
+//  one sample per second, 60 seconds, 60 minutes, 24 hours.
+const uint16_t sizes[3] = { 60, 60, 24 };
+RunningAverageCascade<> cascade(3, sizes);
+
+uint32_t samples = 0;
+
+
+void setup(void)
+{
+  Serial.begin(115200);
+  Serial.println();
+  Serial.println(__FILE__);
+  Serial.print("RUNNINGAVERAGE_LIB_VERSION: ");
+  Serial.println(RUNNINGAVERAGE_LIB_VERSION);
+  Serial.println();
+}
+
+
+void loop(void)
+{
+  //  simulate one sample per second, fast forward.
+  cascade.addValue(random(0, 1000));
+  samples++;
+
+  if (samples % 600 == 0)
+  {
+    runningaverage::RA_BlockWindow<uint16_t, uint64_t> * hour = cascade.getLevel(1);
+    runningaverage::RA_BlockWindow<uint16_t, uint64_t> * day  = cascade.getLevel(2);
+
+    Serial.print(samples);
+    Serial.print("\tminute: ");
+    Serial.print(cascade.getSamples().getFastAverage());
+    Serial.print("\thour: ");
+    Serial.print(hour->getAverage());
+    Serial.print(" [");
+    Serial.print(hour->getMinInBuffer());
+    Serial.print(", ");
+    Serial.print(hour->getMaxInBuffer());
+    Serial.print("]\tday: ");
+    Serial.print(day->getAverage());
+    Serial.print(" (");
+    Serial.print(day->getCount());
+    Serial.println(" hours)");
+  }
+}
+
+
+//  -- END OF FILE --
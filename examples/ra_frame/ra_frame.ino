@@ -0,0 +1,58 @@
+//
+//    FILE: ra_frame.ino
+//  AUTHOR: Rob Tillaart
+//    DATE: 2026-10-16
+// PURPOSE: per pixel running average of an 8x8 thermal sensor (e.g. AMG8833).
+//          the sensor is simulated.
+//     URL: https://github.com/RobTillaart/RunningAverage
+
+
+#include "RunningAverageFrame.h"
+
+
+const uint32_t PIXELS = 64;
+const uint16_t FRAMES = 8;
+
+RunningAverageFrame RAF(PIXELS, FRAMES);
+
+uint16_t frame[PIXELS];
+uint16_t average[PIXELS];
+
+
+void setup(void)
+{
+  Serial.begin(115200);
+  Serial.println();
+  Serial.println(__FILE__);
+  Serial.print("RUNNINGAVERAGE_LIB_VERSION: ");
+  Serial.println(RUNNINGAVERAGE_LIB_VERSION);
+  Serial.println();
+}
+
+
+void loop(void)
+{
+  //  simulate a frame, 0.25 °C units, 25 °C +- noise
+  for (uint32_t i = 0; i < PIXELS; i++)
+  {
+    frame[i] = 100 + random(8);
+  }
+  RAF.addFrame(frame);
+  RAF.getAverage(average);
+
+  for (uint8_t row = 0; row < 8; row++)
+  {
+    for (uint8_t col = 0; col < 8; col++)
+    {
+      Serial.print(average[row * 8 + col] * 0.25, 2);
+      Serial.print('\t');
+    }
+    Serial.println();
+  }
+  Serial.println();
+
+  delay(1000);
+}
+
+
+//  -- END OF FILE --
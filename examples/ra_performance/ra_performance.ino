@@ -7,9 +7,11 @@
 
 
 #include "RunningAverage.h"
+#include "ExponentialAverage.h"
 
 
 RunningAverage myRA(50);
+ExponentialAverage<> myEA(3);  //  alpha = 1/8, no buffer
 int samples = 0;
 
 uint32_t start, stop;
@@ -55,6 +57,10 @@ void setup(void)
   test_getSize();
   test_getCount();
 
+  Serial.println();
+  test_ea_addValue();
+  test_ea_getAverage();
+
   Serial.println("\ndone...\n");
 }
 
@@ -235,6 +241,29 @@ void test_getCount()
 }
 
 
+void test_ea_addValue()
+{
+  myEA.addValue(100);
+  start = micros();
+  myEA.addValue(3141);
+  stop = micros();
+  Serial.print("\tEA addValue \t: ");
+  Serial.println(stop - start);
+  delay(10);
+}
+
+
+void test_ea_getAverage()
+{
+  start = micros();
+  x = myEA.getAverage();
+  stop = micros();
+  Serial.print("\tEA getAverage \t: ");
+  Serial.println(stop - start);
+  delay(10);
+}
+
+
 void loop()
 {
 }
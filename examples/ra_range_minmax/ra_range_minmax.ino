@@ -0,0 +1,89 @@
+//
+//    FILE: ra_range_minmax.ino
+//  AUTHOR: Rob Tillaart
+//    DATE: 2026-10-16
+// PURPOSE: compare getMinInBufferLast() linear scan with RA_RANGE segment tree
+//          to find the crossover point.
+//     URL: https://github.com/RobTillaart/RunningAverage
+
+
+#include "RunningAverage.h"
+
+
+const uint16_t SIZE = 250;
+
+RunningAverage scanRA(SIZE);
+runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_RANGE> treeRA(SIZE);
+
+uint32_t start, stop;
+volatile uint16_t x;
+
+
+void setup(void)
+{
+  Serial.begin(115200);
+  Serial.println();
+  Serial.println(__FILE__);
+  Serial.print("RUNNINGAVERAGE_LIB_VERSION: ");
+  Serial.println(RUNNINGAVERAGE_LIB_VERSION);
+  Serial.println();
+
+  for (uint16_t i = 0; i < SIZE + 17; i++)
+  {
+    uint16_t value = random(4096);
+    scanRA.addValue(value);
+    treeRA.addValue(value);
+  }
+
+  //  addValue() pays for the tree update
+  start = micros();
+  for (int i = 0; i < 100; i++) scanRA.addValue(i);
+  stop = micros();
+  Serial.print("addValue scan:\t");
+  Serial.println((stop - start) * 0.01);
+
+  start = micros();
+  for (int i = 0; i < 100; i++) treeRA.addValue(i);
+  stop = micros();
+  Serial.print("addValue tree:\t");
+  Serial.println((stop - start) * 0.01);
+  Serial.println();
+
+  Serial.println("COUNT\tSCAN\tTREE\t(us per call)");
+  bool crossed = false;
+  for (uint16_t count = 1; count <= SIZE; count *= 2)
+  {
+    start = micros();
+    for (int i = 0; i < 100; i++) x = scanRA.getMinInBufferLast(count);
+    stop = micros();
+    float scan = (stop - start) * 0.01;
+
+    start = micros();
+    for (int i = 0; i < 100; i++) x = treeRA.getMinInBufferLast(count);
+    stop = micros();
+    float tree = (stop - start) * 0.01;
+
+    Serial.print(count);
+    Serial.print('\t');
+    Serial.print(scan, 2);
+    Serial.print('\t');
+    Serial.print(tree, 2);
+    if (!crossed && (tree < scan))
+    {
+      crossed = true;
+      Serial.print("\t<== crossover");
+    }
+    Serial.println();
+  }
+
+  Serial.println("\ndone...\n");
+}
+
+
+void loop(void)
+{
+}
+
+
+//  -- END OF FILE --
+
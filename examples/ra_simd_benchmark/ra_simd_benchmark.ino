@@ -0,0 +1,84 @@
+//
+//    FILE: ra_simd_benchmark.ino
+//  AUTHOR: Rob Tillaart
+//    DATE: 2026-10-16
+// PURPOSE: throughput of the reduction kernels, scalar versus SSE2 / AVX2.
+//          on non x86 targets only the scalar kernels exist.
+//     URL: https://github.com/RobTillaart/RunningAverage
+
+
+#include "RunningAverage.h"
+
+
+const uint16_t SIZE = 4000;
+const uint16_t RUNS = 100;
+
+RunningAverage myRA(SIZE);
+
+uint32_t start, stop;
+volatile uint32_t x;
+
+
+void setup(void)
+{
+  Serial.begin(115200);
+  Serial.println();
+  Serial.println(__FILE__);
+  Serial.print("RUNNINGAVERAGE_LIB_VERSION: ");
+  Serial.println(RUNNINGAVERAGE_LIB_VERSION);
+  Serial.println();
+
+  for (uint16_t i = 0; i < SIZE; i++)
+  {
+    myRA.addValue(random(4096));
+  }
+
+  uint8_t best = runningaverage::ra_simdLevel();
+  Serial.println("LEVEL\tFUNCTION\tSAMPLES/ns");
+  for (uint8_t level = 0; level <= best; level++)
+  {
+    runningaverage::ra_simdSelect(level);
+    test("getAverage", level, 0);
+    test("getMinInBuffer", level, 1);
+    test("getMaxInBuffer", level, 2);
+    test("getStdDev", level, 3);
+    Serial.println();
+  }
+  runningaverage::ra_simdSelect(best);
+
+  Serial.println("\ndone...\n");
+}
+
+
+void test(const char * name, uint8_t level, uint8_t function)
+{
+  start = micros();
+  for (uint16_t r = 0; r < RUNS; r++)
+  {
+    switch (function)
+    {
+      case 0: x = myRA.getAverage(); break;
+      case 1: x = myRA.getMinInBuffer(); break;
+      case 2: x = myRA.getMaxInBuffer(); break;
+      case 3: x = myRA.getStandardDeviation(); break;
+    }
+  }
+  stop = micros();
+
+  float samplesPerNs = (1.0 * SIZE * RUNS) / ((stop - start) * 1000.0);
+  Serial.print(level == 0 ? "scalar" : (level == 1 ? "SSE2" : "AVX2"));
+  Serial.print('\t');
+  Serial.print(name);
+  Serial.print('\t');
+  Serial.println(samplesPerNs, 3);
+  delay(10);
+}
+
+
+void loop(void)
+{
+}
+
+
+//  -- END OF FILE --
+
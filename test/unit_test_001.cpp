@@ -34,6 +34,19 @@
 
 #include "Arduino.h"
 #include "RunningAverage.h"
+#include "RunningAverageStatic.h"
+#include "RunningAverageSIMD.h"
+#include "RunningAverageBank.h"
+#include "RunningAverageFrame.h"
+#include "RunningAverageQueue.h"
+#include "RunningAverageSnapshot.h"
+#include "RunningAverageCascade.h"
+#include "RunningAverageTimed.h"
+#include "RunningAverageMode.h"
+#include "ExponentialAverage.h"
+#include "RunningAverageFile.h"
+
+#include <vector>
 
 
 unittest_setup()
@@ -58,8 +71,32 @@ unittest(test_zero_elements)
   int cnt = myRA.getCount();
   assertEqual(0, cnt);
 
-  float x = myRA.getAverage();
-  assertNAN(x);
+  assertEqual(0, myRA.getAverage());
+  assertEqual(0, myRA.getFastAverage());
+  //  size 0, allocated and caller buffer, has no buffer and ignores values.
+  RunningAverage noRA(0);
+  uint16_t none[1] = { 42 };
+  RunningAverage callerRA(0, none);
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_MINMAX | runningaverage::RA_PREFIX> optionRA(0);
+  for (int i = 0; i < 10; i++)
+  {
+    noRA.addValue(i);
+    callerRA.addValue(i);
+    optionRA.addValue(i);
+  }
+  assertEqual(0, noRA.getSize());
+  assertEqual(0, noRA.getCount());
+  assertEqual(0, noRA.getFastAverage());
+  assertEqual(0, callerRA.getSize());
+  assertEqual(0, callerRA.getCount());
+  assertEqual(42, none[0]);
+  assertEqual(0, optionRA.getCount());
+  assertEqual(0, optionRA.getMinInBuffer());
+  //  can grow later
+  assertTrue(callerRA.resize(4));
+  callerRA.addValue(8);
+  assertEqual(8, callerRA.getFastAverage());
+  assertEqual(42, none[0]);
 }
 
 
@@ -68,20 +105,20 @@ unittest(test_min_max)
   RunningAverage myRA(10);
   myRA.clear();
 
-  for (int i = -5; i < 6; i++)
+  for (int i = 0; i < 11; i++)
   {
     myRA.addValue(i);
   }
 
-  float mi = myRA.getMin();
-  assertEqual(-5, mi);
-  float ma = myRA.getMax();
-  assertEqual(5, ma);
+  uint16_t mi = myRA.getMin();
+  assertEqual(0, mi);
+  uint16_t ma = myRA.getMax();
+  assertEqual(10, ma);
 
   mi = myRA.getMinInBuffer();
-  assertEqual(-4, mi);
+  assertEqual(1, mi);
   ma = myRA.getMaxInBuffer();
-  assertEqual(5, ma);
+  assertEqual(10, ma);
 }
 
 
@@ -130,14 +167,14 @@ unittest(test_partial)
   {
     myRA.addValue(i);
   }
-  assertEqualFloat(94.5, myRA.getAverage(), 0.001);
+  assertEqual(94, myRA.getAverage());
 
   myRA.setPartial(20);
   for (int i = 0; i < 100; i++)
   {
     myRA.addValue(i);
   }
-  assertEqualFloat(89.5, myRA.getAverage(), 0.001);
+  assertEqual(89, myRA.getAverage());
 }
 
 
@@ -151,25 +188,1654 @@ unittest(test_last)
   {
     myRA.addValue(i);
   }
-  assertNAN(myRA.getMinInBufferLast(0));
-  assertNAN(myRA.getAverageLast(0));
-  assertNAN(myRA.getMaxInBufferLast(0));
+  assertEqual(0, myRA.getMinInBufferLast(0));
+  assertEqual(0, myRA.getAverageLast(0));
+  assertEqual(0, myRA.getMaxInBufferLast(0));
+
+  assertEqual(999, myRA.getMinInBufferLast(1));
+  assertEqual(999, myRA.getAverageLast(1));
+  assertEqual(999, myRA.getMaxInBufferLast(1));
+
+  assertEqual(990, myRA.getMinInBufferLast(10));
+  assertEqual(994, myRA.getAverageLast(10));
+  assertEqual(999, myRA.getMaxInBufferLast(10));
+
+  assertEqual(900, myRA.getMinInBufferLast(100));
+  assertEqual(949, myRA.getAverageLast(100));
+  assertEqual(999, myRA.getMaxInBufferLast(100));
+
+  assertEqual(700, myRA.getMinInBufferLast(1000));
+  assertEqual(849, myRA.getAverageLast(1000));
+  assertEqual(999, myRA.getMaxInBufferLast(1000));
+}
+
+
+unittest(test_wide_accumulator)
+{
+  //  12 bit ADC full scale overflows a 16 bit sum after 16 values.
+  RunningAverage myRA(1000);
+  for (int i = 0; i < 2000; i++)
+  {
+    myRA.addValue(4095);
+  }
+  assertEqual(4095, myRA.getFastAverage());
+  assertEqual(4095, myRA.getAverage());
+  assertEqual(4095000UL, myRA.getSum());
+
+  //  64 bit accumulator
+  runningaverage::RunningAverage<uint16_t, uint64_t> bigRA(65535);
+  for (uint32_t i = 0; i < 70000UL; i++)
+  {
+    bigRA.addValue(65535);
+  }
+  assertEqual(65535, bigRA.getFastAverage());
+  assertEqual(65535, bigRA.getAverage());
+}
+
+
+unittest(test_partial_last)
+{
+  RunningAverage myRA(100);
+  myRA.setPartial(10);
+  for (int i = 0; i < 25; i++)
+  {
+    myRA.addValue(i);
+  }
+  //  last functions wrap around partial, not size
+  assertEqual(24, myRA.getMaxInBufferLast(10));
+  assertEqual(15, myRA.getMinInBufferLast(10));
+  assertEqual(19, myRA.getAverageLast(10));
+}
+
+
+unittest(test_static)
+{
+  RunningAverageStatic<16> myRA;
+  assertEqual(16, myRA.getSize());
+  assertEqual(0, myRA.getFastAverage());
+
+  for (int i = 0; i < 100; i++)
+  {
+    myRA.addValue(i);
+  }
+  assertTrue(myRA.bufferIsFull());
+  assertEqual(91, myRA.getFastAverage());
+  assertEqual(91, myRA.getAverage());
+  assertEqual(84, myRA.getMinInBuffer());
+  assertEqual(99, myRA.getMaxInBuffer());
+  assertEqual(84, myRA.getValue(0));
+  assertEqual(97, myRA.getAverageLast(5));
+
+  //  partial is exact, also for a power of two, same as RunningAverage
+  RunningAverage dynRA(16);
+  for (int i = 0; i < 100; i++) dynRA.addValue(i);
+  myRA.setPartial(10);
+  dynRA.setPartial(10);
+  assertEqual(10, myRA.getPartial());
+  for (int i = 0; i < 100; i++)
+  {
+    myRA.addValue(i * 3 + (i % 7));
+    dynRA.addValue(i * 3 + (i % 7));
+    assertEqual(dynRA.getFastAverage(), myRA.getFastAverage());
+    assertEqual(dynRA.getAverageLast(4), myRA.getAverageLast(4));
+  }
+  myRA.setPartial();
+  assertEqual(16, myRA.getPartial());
+  for (int i = 0; i < 20; i++) myRA.addValue(i);
+  assertEqual(11, myRA.getFastAverage());   //  4 .. 19, by SHIFT
+
+  //  not a power of two
+  RunningAverageStatic<10> raTen;
+  for (int i = 0; i < 100; i++)
+  {
+    raTen.addValue(i);
+  }
+  assertEqual(94, raTen.getFastAverage());
+  assertEqual(90, raTen.getMinInBufferLast(10));
+  raTen.setPartial(5);
+  assertEqual(5, raTen.getPartial());
+
+  //  subset on a buffer that is not full, oldest first like RunningAverage
+  RunningAverageStatic<8> raEight;
+  RunningAverage raDyn(8);
+  assertTrue(isnan(raEight.getAverageSubset(0, 3)));
+  for (int i = 1; i <= 3; i++)
+  {
+    raEight.addValue(i * 10);
+    raDyn.addValue(i * 10);
+  }
+  assertEqualFloat(20, raEight.getAverageSubset(0, 3), 0.0001);
+  assertEqualFloat(25, raEight.getAverageSubset(1, 10), 0.0001);
+  assertTrue(isnan(raEight.getAverageSubset(3, 2)));
+  for (int i = 4; i <= 11; i++)
+  {
+    raEight.addValue(i * 10);
+    raDyn.addValue(i * 10);
+  }
+  for (uint16_t s = 0; s < 8; s++)
+  {
+    assertEqualFloat(raDyn.getAverageSubset(s, 3), raEight.getAverageSubset(s, 3), 0.0001);
+  }
+  assertEqual(3, (int)RunningAverageStatic<8>::SHIFT);
+  assertEqual(7, (int)RunningAverageStatic<8>::MASK);
+}
+
+
+unittest(test_minmax_deque)
+{
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_MINMAX> fastRA(50);
+  RunningAverage slowRA(50);
+
+  randomSeed(42);
+  for (int p = 0; p < 3; p++)
+  {
+    if (p == 1)
+    {
+      fastRA.setPartial(17);
+      slowRA.setPartial(17);
+    }
+    if (p == 2)
+    {
+      fastRA.clear();
+      slowRA.clear();
+    }
+    for (int i = 0; i < 500; i++)
+    {
+      uint16_t v = random(1000);
+      fastRA.addValue(v);
+      slowRA.addValue(v);
+      assertEqual(slowRA.getMinInBuffer(), fastRA.getMinInBuffer());
+      assertEqual(slowRA.getMaxInBuffer(), fastRA.getMaxInBuffer());
+    }
+  }
+  fastRA.fillValue(7, 5);
+  assertEqual(7, fastRA.getMinInBuffer());
+  assertEqual(7, fastRA.getMaxInBuffer());
+}
+
+
+unittest(test_moments)
+{
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_MOMENTS4> fastRA(100);
+  RunningAverage slowRA(100);
+
+  assertNAN(fastRA.getVariance());
+  assertNAN(fastRA.getRMS());
+
+  randomSeed(7);
+  for (int i = 0; i < 1000; i++)
+  {
+    uint16_t v = 1000 + random(100) + (i % 7) * (i % 5);
+    fastRA.addValue(v);
+    slowRA.addValue(v);
+  }
+  assertEqualFloat(slowRA.getVariance(), fastRA.getVariance(), 0.01);
+  assertEqualFloat(slowRA.getStandardDeviation(), fastRA.getStandardDeviation(), 0.001);
+  assertEqualFloat(slowRA.getStandardError(), fastRA.getStandardError(), 0.001);
+  assertEqualFloat(slowRA.getRMS(), fastRA.getRMS(), 0.01);
+  assertEqualFloat(slowRA.getSkewness(), fastRA.getSkewness(), 0.01);
+  assertEqualFloat(slowRA.getKurtosis(), fastRA.getKurtosis(), 0.01);
+
+  //  simple known values
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_MOMENTS> ra(4);
+  ra.addValue(2);
+  ra.addValue(4);
+  ra.addValue(4);
+  ra.addValue(6);
+  assertEqualFloat(8.0 / 3, ra.getVariance(), 0.0001);
+  assertEqualFloat(sqrt(18.0), ra.getRMS(), 0.0001);
+  assertEqualFloat(0.0, ra.getSkewness(), 0.0001);
+  ra.fillValue(5, 4);
+  assertEqualFloat(0.0, ra.getVariance(), 0.0001);
+  assertNAN(ra.getSkewness());
+  //  12 bit samples with a large offset, against a two pass in double.
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_MOMENTS4> offsetRA(500);
+  std::vector<uint16_t> values;
+  randomSeed(11);
+  for (int i = 0; i < 2000; i++)
+  {
+    uint16_t v = 4090 + random(6) * random(2);
+    offsetRA.addValue(v);
+    values.push_back(v);
+  }
+  double mean = 0;
+  for (int i = 1500; i < 2000; i++) mean += values[i];
+  mean /= 500;
+  double s2 = 0, s3 = 0, s4 = 0;
+  for (int i = 1500; i < 2000; i++)
+  {
+    double d = values[i] - mean;
+    s2 += d * d;
+    s3 += d * d * d;
+    s4 += d * d * d * d;
+  }
+  s2 /= 500;
+  s3 /= 500;
+  s4 /= 500;
+  assertEqualFloat(s3 / (s2 * sqrt(s2)), offsetRA.getSkewness(), 0.00001);
+  assertEqualFloat(s4 / (s2 * s2) - 3, offsetRA.getKurtosis(), 0.00001);
+  //  full 16 bit range, the shifted 4th power sum does not fit 64 bit
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_MOMENTS4> fullRA(100);
+  RunningAverage fullSlowRA(100);
+  for (int i = 0; i < 100; i++)
+  {
+    fullRA.addValue((i & 1) ? 65535 : 0);
+    fullSlowRA.addValue((i & 1) ? 65535 : 0);
+  }
+  assertNAN(fullRA.getSkewness());
+  assertNAN(fullRA.getKurtosis());
+  assertEqualFloat(-2.0, fullSlowRA.getKurtosis(), 0.001);
+  assertEqualFloat(fullSlowRA.getVariance(), fullRA.getVariance(), 1);
+  //  a 12 bit range is always fine
+  fullRA.clear();
+  for (int i = 0; i < 100; i++) fullRA.addValue(60000 + 4095 * (i & 1));
+  assertEqualFloat(-2.0, fullRA.getKurtosis(), 0.001);
+}
+
+
+unittest(test_prefix)
+{
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_PREFIX> fastRA(300);
+  RunningAverage slowRA(300);
+
+  randomSeed(3);
+  for (int p = 0; p < 2; p++)
+  {
+    if (p == 1)
+    {
+      fastRA.setPartial(77);
+      slowRA.setPartial(77);
+    }
+    for (int i = 0; i < 1000; i++)
+    {
+      uint16_t v = random(65535);
+      fastRA.addValue(v);
+      slowRA.addValue(v);
+      uint16_t k = 1 + random(300);
+      uint16_t start = random(slowRA.getCount());
+      assertEqual(slowRA.getAverageLast(k), fastRA.getAverageLast(k));
+      assertEqualFloat(slowRA.getAverageSubset(start, k), fastRA.getAverageSubset(start, k), 0.01);
+    }
+  }
+}
+
+
+unittest(test_subset)
+{
+  RunningAverage myRA(10);
+  assertNAN(myRA.getAverageSubset(0, 5));
+  for (int i = 0; i < 5; i++)
+  {
+    myRA.addValue(i);
+  }
+  //  not full, oldest is 0
+  assertEqualFloat(1.0, myRA.getAverageSubset(0, 3), 0.001);
+  assertEqualFloat(3.5, myRA.getAverageSubset(3, 5), 0.001);
+  assertNAN(myRA.getAverageSubset(5, 5));
+
+  for (int i = 5; i < 20; i++)
+  {
+    myRA.addValue(i);
+  }
+  assertEqualFloat(12.0, myRA.getAverageSubset(0, 5), 0.001);
+  assertEqualFloat(15.0, myRA.getAverageSubset(3, 5), 0.001);
+  assertEqualFloat(17.0, myRA.getAverageSubset(5, 5), 0.001);
+}
+
+
+unittest(test_range_minmax)
+{
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_RANGE> fastRA(100);
+  RunningAverage slowRA(100);
+
+  randomSeed(11);
+  for (int p = 0; p < 2; p++)
+  {
+    if (p == 1)
+    {
+      fastRA.setPartial(33);
+      slowRA.setPartial(33);
+    }
+    for (int i = 0; i < 500; i++)
+    {
+      uint16_t v = random(10000);
+      fastRA.addValue(v);
+      slowRA.addValue(v);
+      uint16_t k = 1 + random(100);
+      uint16_t start = random(slowRA.getCount());
+      assertEqual(slowRA.getMinInBufferLast(k), fastRA.getMinInBufferLast(k));
+      assertEqual(slowRA.getMaxInBufferLast(k), fastRA.getMaxInBufferLast(k));
+      assertEqual(slowRA.getMinInBufferSubset(start, k), fastRA.getMinInBufferSubset(start, k));
+      assertEqual(slowRA.getMaxInBufferSubset(start, k), fastRA.getMaxInBufferSubset(start, k));
+      assertEqual(slowRA.getMinInBuffer(), fastRA.getMinInBuffer());
+      assertEqual(slowRA.getMaxInBuffer(), fastRA.getMaxInBuffer());
+    }
+  }
+
+  RunningAverage myRA(10);
+  for (int i = 0; i < 15; i++)
+  {
+    myRA.addValue(i);
+  }
+  assertEqual(8, myRA.getMinInBufferSubset(3, 4));
+  assertEqual(11, myRA.getMaxInBufferSubset(3, 4));
+  assertEqual(0, myRA.getMinInBufferSubset(10, 4));
+}
+
+
+unittest(test_addValues)
+{
+  RunningAverage bulkRA(100);
+  RunningAverage slowRA(100);
+  uint16_t block[300];
+
+  randomSeed(5);
+  for (int p = 0; p < 2; p++)
+  {
+    if (p == 1)
+    {
+      bulkRA.setPartial(37);
+      slowRA.setPartial(37);
+    }
+    for (int r = 0; r < 50; r++)
+    {
+      uint16_t n = random(300);
+      for (uint16_t i = 0; i < n; i++)
+      {
+        block[i] = random(65535);
+        slowRA.addValue(block[i]);
+      }
+      bulkRA.addValues(block, n);
+      assertEqual(slowRA.getCount(), bulkRA.getCount());
+      assertEqual(slowRA.getSum(), bulkRA.getSum());
+      assertEqual(slowRA.getMin(), bulkRA.getMin());
+      assertEqual(slowRA.getMax(), bulkRA.getMax());
+      assertEqual(slowRA.getValue(0), bulkRA.getValue(0));
+      assertEqual(slowRA.getAverageLast(10), bulkRA.getAverageLast(10));
+      assertEqual(slowRA.getFastAverage(), bulkRA.getAverage());
+    }
+  }
+
+  //  options fall back to addValue()
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_MINMAX> optRA(10);
+  optRA.addValues(block, 25);
+  assertEqual(10, optRA.getCount());
+  uint16_t lo = block[15];
+  for (int i = 16; i < 25; i++) if (block[i] < lo) lo = block[i];
+  assertEqual(lo, optRA.getMinInBuffer());
+}
+
+
+//  kernel call from a static constructor, its order relative to the
+//  statics of RunningAverageSIMD.cpp is unspecified.
+static const uint16_t earlyValues[4] = { 1, 2, 3, 4 };
+static const uint32_t earlySum = runningaverage::ra_sum(earlyValues, 4);
+
+
+unittest(test_simd_kernels)
+{
+  using namespace runningaverage;
+  assertEqual(10, earlySum);
+
+  static uint16_t data[1000];
+  randomSeed(13);
+  for (int i = 0; i < 1000; i++) data[i] = random(65536);
+  data[500] = 65535;
+  data[501] = 0;
+
+  uint8_t best = ra_simdLevel();
+  for (uint8_t level = RA_SIMD_SCALAR; level <= best; level++)
+  {
+    assertEqual(level, ra_simdSelect(level));
+    for (uint16_t n = 1; n < 1000; n += 37)
+    {
+      uint16_t * p = data + (n % 5);   //  unaligned
+      uint32_t sum = 0;
+      uint64_t ssq = 0;
+      uint16_t lo = p[0];
+      uint16_t hi = p[0];
+      for (uint16_t i = 0; i < n; i++)
+      {
+        sum += p[i];
+        ssq += (uint64_t)p[i] * p[i];
+        if (p[i] < lo) lo = p[i];
+        if (p[i] > hi) hi = p[i];
+      }
+      assertEqual(sum, ra_sum(p, n));
+      assertEqual(ssq, ra_sumSquares(p, n));
+      assertEqual(lo, ra_min(p, n));
+      assertEqual(hi, ra_max(p, n));
+    }
+  }
+  ra_simdSelect(best);
+}
+
+
+unittest(test_quotient)
+{
+  using runningaverage::RA_ROUND_FLOOR;
+  using runningaverage::RA_ROUND_NEAREST;
+  using runningaverage::RA_ROUND_BANKER;
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_QUOTIENT> fastRA(64);
+  RunningAverage slowRA(64);
+
+  randomSeed(17);
+  for (uint8_t mode = RA_ROUND_FLOOR; mode <= RA_ROUND_BANKER; mode++)
+  {
+    fastRA.setRounding(mode);
+    slowRA.setRounding(mode);
+    assertEqual(mode, fastRA.getRounding());
+    for (int p = 0; p < 2; p++)
+    {
+      if (p == 1)
+      {
+        fastRA.setPartial(10);
+        slowRA.setPartial(10);
+      }
+      for (int i = 0; i < 1000; i++)
+      {
+        //  small and large steps
+        uint16_t v = (i % 50 < 25) ? 1000 + random(10) : random(65535);
+        fastRA.addValue(v);
+        slowRA.addValue(v);
+        assertEqual(slowRA.getFastAverage(), fastRA.getFastAverage());
+      }
+    }
+  }
+
+  //  rounding modes on exact halves
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_QUOTIENT> ra(2);
+  ra.addValue(2);
+  ra.addValue(3);   //  2.5
+  ra.setRounding(RA_ROUND_FLOOR);
+  assertEqual(2, ra.getFastAverage());
+  ra.setRounding(RA_ROUND_NEAREST);
+  assertEqual(3, ra.getFastAverage());
+  ra.setRounding(RA_ROUND_BANKER);
+  assertEqual(2, ra.getFastAverage());
+  ra.addValue(4);   //  3.5
+  assertEqual(4, ra.getFastAverage());
+  //  32 bit samples, the delta does not fit int32_t
+  runningaverage::RunningAverage<uint32_t, uint64_t, runningaverage::RA_QUOTIENT> wideRA(8);
+  runningaverage::RunningAverage<uint32_t, uint64_t> wideSlowRA(8);
+  for (int i = 0; i < 100; i++)
+  {
+    uint32_t v = (i % 3 == 0) ? 4000000000UL + i : 7 * i;
+    wideRA.addValue(v);
+    wideSlowRA.addValue(v);
+    assertEqual(wideSlowRA.getFastAverage(), wideRA.getFastAverage());
+  }
+  wideRA.fillValue(1000000002UL, 8);
+  wideRA.addValue(1000000002UL);
+  assertEqual(1000000002UL, wideRA.getFastAverage());
+}
+
+
+//  NAN equals NAN, e.g. getVariance() with count < 2
+bool sameFloat(float a, float b)
+{
+  return (a == b) || (isnan(a) && isnan(b));
+}
+
+
+//  compares the state visible through the API of two RunningAverage objects.
+template <class R>
+bool sameState(R & a, R & b)
+{
+  if (a.getCount() != b.getCount()) return false;
+  if (a.getSum() != b.getSum()) return false;
+  if (a.getAverage() != b.getAverage()) return false;
+  if (a.getFastAverage() != b.getFastAverage()) return false;
+  if (a.getMin() != b.getMin()) return false;
+  if (a.getMax() != b.getMax()) return false;
+  if (a.getMinInBuffer() != b.getMinInBuffer()) return false;
+  if (a.getMaxInBuffer() != b.getMaxInBuffer()) return false;
+  if (!sameFloat(a.getVariance(), b.getVariance())) return false;
+  if (!sameFloat(a.getRMS(), b.getRMS())) return false;
+  for (uint16_t i = 0; i < a.getCount(); i++)
+  {
+    if (a.getElement(i) != b.getElement(i)) return false;
+    if (a.getValue(i) != b.getValue(i)) return false;
+    if (a.getAverageLast(i + 1) != b.getAverageLast(i + 1)) return false;
+    if (a.getMinInBufferLast(i + 1) != b.getMinInBufferLast(i + 1)) return false;
+    if (a.getMaxInBufferLast(i + 1) != b.getMaxInBufferLast(i + 1)) return false;
+  }
+  return true;
+}
+
+
+//  fillValue() lazily, reference by clear() + addValue()
+template <class R>
+bool lazyFillMatches(R & lazyRA, R & slowRA, uint16_t partial)
+{
+  lazyRA.setPartial(partial);
+  slowRA.setPartial(partial);
+  for (int r = 0; r < 20; r++)
+  {
+    uint16_t value  = random(65535);
+    uint16_t number = random(partial + 5);
+    lazyRA.fillValue(value, number);
+    slowRA.clear();
+    for (uint16_t i = 0; i < number && i < partial; i++) slowRA.addValue(value);
+    if (!sameState(lazyRA, slowRA)) return false;
+    uint16_t adds = random(2 * partial);
+    for (uint16_t i = 0; i < adds; i++)
+    {
+      uint16_t v = random(65535);
+      lazyRA.addValue(v);
+      slowRA.addValue(v);
+      if (!sameState(lazyRA, slowRA)) return false;
+    }
+  }
+  return true;
+}
+
+
+unittest(test_lazy_fill)
+{
+  using runningaverage::RA_MINMAX;
+  using runningaverage::RA_MOMENTS4;
+  using runningaverage::RA_PREFIX;
+  using runningaverage::RA_QUOTIENT;
+  using runningaverage::RA_RANGE;
+  randomSeed(23);
+
+  RunningAverage plainA(40), plainB(40);
+  assertTrue(lazyFillMatches(plainA, plainB, 40));
+  assertTrue(lazyFillMatches(plainA, plainB, 13));
+
+  runningaverage::RunningAverage<uint16_t, uint32_t, RA_MINMAX | RA_MOMENTS4 | RA_PREFIX | RA_QUOTIENT> optA(40), optB(40);
+  assertTrue(lazyFillMatches(optA, optB, 40));
+  assertTrue(lazyFillMatches(optA, optB, 13));
+
+  runningaverage::RunningAverage<uint16_t, uint32_t, RA_RANGE> rangeA(40), rangeB(40);
+  assertTrue(lazyFillMatches(rangeA, rangeB, 40));
+  assertTrue(lazyFillMatches(rangeA, rangeB, 13));
+
+  //  addValues() after fillValue()
+  uint16_t block[30];
+  for (int i = 0; i < 30; i++) block[i] = i * 100;
+  plainA.setPartial(40);
+  plainB.setPartial(40);
+  plainA.fillValue(7, 25);
+  plainB.clear();
+  for (int i = 0; i < 25; i++) plainB.addValue(7);
+  plainA.addValues(block, 30);
+  for (int i = 0; i < 30; i++) plainB.addValue(block[i]);
+  assertTrue(sameState(plainA, plainB));
+
+  //  clear() does not need a zeroed buffer
+  plainA.clear();
+  plainA.addValue(5);
+  assertEqual(5, plainA.getAverage());
+  assertEqual(5, plainA.getMinInBuffer());
+  assertEqual(0, plainA.getElement(1));
+}
+
+
+unittest(test_bank)
+{
+  const uint16_t CHANNELS = 50;
+  RunningAverageBank<> bank(CHANNELS, 12);
+  RunningAverage * single[CHANNELS];
+  for (uint16_t c = 0; c < CHANNELS; c++) single[c] = new RunningAverage(12);
+
+  assertEqual(CHANNELS, bank.getChannels());
+  assertEqual(12, bank.getSize());
+
+  randomSeed(29);
+  uint16_t averages[CHANNELS];
+  for (int i = 0; i < 2000; i++)
+  {
+    uint16_t c = random(CHANNELS);
+    uint16_t v = random(65535);
+    bank.addValue(c, v);
+    single[c]->addValue(v);
+    if (i % 97 == 0) bank.getFastAverages(averages);
+    for (uint16_t k = 0; k < CHANNELS && (i % 97 == 0); k++)
+    {
+      assertEqual(single[k]->getFastAverage(), averages[k]);
+    }
+  }
+  for (uint16_t c = 0; c < CHANNELS; c++)
+  {
+    assertEqual(single[c]->getCount(), bank.getCount(c));
+    assertEqual(single[c]->getSum(), bank.getSum(c));
+    assertEqual(single[c]->getAverage(), bank.getAverage(c));
+    assertEqual(single[c]->getMin(), bank.getMin(c));
+    assertEqual(single[c]->getMax(), bank.getMax(c));
+    assertEqual(single[c]->bufferIsFull(), bank.bufferIsFull(c));
+    for (uint16_t p = 0; p < 12; p++)
+    {
+      assertEqual(single[c]->getValue(p), bank.getValue(c, p));
+    }
+  }
+
+  bank.clear(3);
+  assertEqual(0, bank.getCount(3));
+  assertEqual(0, bank.getFastAverage(3));
+  assertEqual(single[4]->getFastAverage(), bank.getFastAverage(4));
+  bank.addValue(CHANNELS, 100);  //  ignored
+  assertEqual(0, bank.getCount(CHANNELS));
+
+  for (uint16_t c = 0; c < CHANNELS; c++) delete single[c];
+}
+
+
+unittest(test_frame)
+{
+  const uint32_t PIXELS = 77;  //  not a multiple of 16, tests the tails
+  uint16_t frame[PIXELS];
+  uint16_t avg[PIXELS], lo[PIXELS], hi[PIXELS];
+  RunningAverage * pixel[PIXELS];
+  for (uint32_t p = 0; p < PIXELS; p++) pixel[p] = new RunningAverage(5);
+
+  randomSeed(31);
+  uint8_t best = runningaverage::ra_simdLevel();
+  for (uint8_t level = 0; level <= best; level++)
+  {
+    runningaverage::ra_simdSelect(level);
+    RunningAverageFrame fra(PIXELS, 5);
+    assertEqual(PIXELS, fra.getPixels());
+    assertFalse(fra.getAverage(avg));
+    for (uint32_t p = 0; p < PIXELS; p++) pixel[p]->clear();
+
+    for (int f = 0; f < 12; f++)
+    {
+      for (uint32_t p = 0; p < PIXELS; p++)
+      {
+        frame[p] = (f & 1) ? random(65535) : 65535 - random(4);
+        pixel[p]->addValue(frame[p]);
+      }
+      fra.addFrame(frame);
+      assertTrue(fra.getAverage(avg));
+      fra.getMin(lo);
+      fra.getMax(hi);
+      for (uint32_t p = 0; p < PIXELS; p++)
+      {
+        assertEqual(pixel[p]->getFastAverage(), avg[p]);
+        assertEqual(pixel[p]->getMinInBuffer(), lo[p]);
+        assertEqual(pixel[p]->getMaxInBuffer(), hi[p]);
+        assertEqual(pixel[p]->getSum(), fra.getSum(p));
+      }
+    }
+    assertTrue(fra.bufferIsFull());
+    assertEqual(pixel[3]->getValue(0), fra.getFrame(0)[3]);
+    assertEqual(frame[3], fra.getFrame(4)[3]);
+    assertNull(fra.getFrame(5));
+  }
+  runningaverage::ra_simdSelect(best);
+  for (uint32_t p = 0; p < PIXELS; p++) delete pixel[p];
 
-  assertEqualFloat(999.0, myRA.getMinInBufferLast(1), 0.001);
-  assertEqualFloat(999.0, myRA.getAverageLast(1), 0.001);
-  assertEqualFloat(999.0, myRA.getMaxInBufferLast(1), 0.001);
+  //  the division by multiply is exact for every count
+  uint32_t sums[64];
+  uint16_t out[64];
+  for (uint8_t level = 0; level <= best; level++)
+  {
+    runningaverage::ra_simdSelect(level);
+    for (uint32_t count = 1; count < 65536; count += 1 + (count >> 4))
+    {
+      for (int i = 0; i < 64; i++)
+      {
+        uint32_t q = random(65536);
+        uint32_t r = (i & 1) ? count - 1 : random(count);
+        sums[i] = q * count + r;
+      }
+      runningaverage::ra_frameAverage(out, sums, 64, count);
+      for (int i = 0; i < 64; i++)
+      {
+        assertEqual(sums[i] / count, out[i]);
+      }
+    }
+  }
+  runningaverage::ra_simdSelect(best);
+}
+
+
+unittest(test_queue)
+{
+  RunningAverageQueue<64> queue(100);
+  RunningAverage slowRA(100);
+  assertEqual(64, queue.getCapacity());
+
+  randomSeed(37);
+  for (int r = 0; r < 200; r++)
+  {
+    uint16_t n = random(64);
+    for (uint16_t i = 0; i < n; i++)
+    {
+      uint16_t v = random(65535);
+      assertTrue(queue.addValue(v));
+      slowRA.addValue(v);
+    }
+    assertEqual(n, queue.available());
+    assertEqual(slowRA.getFastAverage(), queue.window().getFastAverage());
+    assertEqual(slowRA.getMinInBuffer(), queue.window().getMinInBuffer());
+    assertEqual(slowRA.getCount(), queue.window().getCount());
+    assertEqual(0, queue.available());
+  }
+
+  //  full queue drops
+  for (int i = 0; i < 70; i++) queue.addValue(i);
+  assertEqual(64, queue.available());
+  assertEqual(6, queue.getDropped());
+  assertEqual(64, queue.drain());
+  assertEqual(63, queue.window().getValue(99));
+}
+
+
+unittest(test_snapshot)
+{
+  const RunningAverage constRA(10);
+  assertEqual(0, constRA.getAverage());  //  const since 0.5.0
+
+  RunningAverage myRA(10);
+  RunningAverageSnapshot<> snapshot;
+  runningaverage::RA_Snapshot<uint16_t> snap = snapshot.read();
+  assertEqual(0, snap.count);
+  assertNAN(snap.stddev);
+  assertEqual(0, snapshot.getVersion());
+
+  for (int i = 1; i <= 5; i++) myRA.addValue(i * 10);
+  snapshot.publish(myRA);
+  assertEqual(2, snapshot.getVersion());
+  assertTrue(snapshot.tryRead(snap));
+  assertEqual(30, snap.average);
+  assertEqual(10, snap.minimum);
+  assertEqual(50, snap.maximum);
+  assertEqual(5, snap.count);
+  assertEqualFloat(myRA.getStandardDeviation(), snap.stddev, 0.0001);
+}
+
+
+unittest(test_cascade)
+{
+  const uint16_t sizes[3] = { 10, 6, 4 };
+  RunningAverageCascade<> cascade(3, sizes);
+  assertEqual(3, cascade.getLevels());
+  assertNull(cascade.getLevel(0));
+  assertNull(cascade.getLevel(3));
+
+  //  reference, the raw history of level 2 = 4 * 6 * 10 samples
+  RunningAverage history(240);
+  RunningAverage lastBlock(60);
+  randomSeed(41);
+  for (int i = 0; i < 1000; i++)
+  {
+    uint16_t v = random(65535);
+    cascade.addValue(v);
+    history.addValue(v);
+    lastBlock.addValue(v);
+
+    //  level 1 covers the last multiple of 10 samples
+    if ((i + 1) % 60 == 0)
+    {
+      runningaverage::RA_BlockWindow<uint16_t, uint64_t> * minutes = cascade.getLevel(1);
+      runningaverage::RA_BlockWindow<uint16_t, uint64_t> * hours = cascade.getLevel(2);
+      assertEqual(6, minutes->getCount());
+      assertEqual(60, minutes->getSampleCount());
+      assertEqual(lastBlock.getSum(), minutes->getSum());
+      assertEqual(lastBlock.getAverage(), minutes->getAverage());
+      assertEqual(lastBlock.getMinInBuffer(), minutes->getMinInBuffer());
+      assertEqual(lastBlock.getMaxInBuffer(), minutes->getMaxInBuffer());
+      assertEqual(history.getSum(), hours->getSum());
+      assertEqual(history.getMinInBuffer(), hours->getMinInBuffer());
+      assertEqual(history.getMaxInBuffer(), hours->getMaxInBuffer());
+      assertEqual(history.getCount(), hours->getSampleCount());
+      //  newest block of level 2 is the average of the last 60 samples
+      assertEqual(lastBlock.getAverage(), hours->getValue(hours->getCount() - 1));
+    }
+  }
+  assertEqual(10, cascade.getSamples().getCount());
+  assertTrue(cascade.getLevel(2)->bufferIsFull());
+
+  cascade.clear();
+  assertEqual(0, cascade.getLevel(1)->getCount());
+  assertEqual(0, cascade.getLevel(2)->getAverage());
+  //  a level of size 0 has no buffer and ignores its blocks
+  const uint16_t holes[3] = { 4, 0, 3 };
+  RunningAverageCascade<> holey(3, holes);
+  for (int i = 0; i < 100; i++) holey.addValue(i);
+  assertEqual(0, holey.getLevel(1)->getSize());
+  assertEqual(0, holey.getLevel(1)->getCount());
+  assertEqual(0, holey.getLevel(1)->getMinInBuffer());
+  assertEqual(3, holey.getLevel(2)->getCount());
+  assertEqual(4, holey.getSamples().getCount());
+}
+
+
+static uint32_t fakeNow = 0;
+uint32_t fakeClock() { return fakeNow; }
+
+
+//  reference: average etc. over the samples of the last window by brute force.
+template <class R>
+bool timedMatches(R & timed, const uint16_t * values, const uint32_t * stamps, int n, uint32_t window)
+{
+  uint32_t sum = 0;
+  uint16_t count = 0, lo = 0, hi = 0;
+  for (int i = 0; i < n; i++)
+  {
+    if (fakeNow - stamps[i] >= window) continue;
+    if (count == 0 || values[i] < lo) lo = values[i];
+    if (count == 0 || values[i] > hi) hi = values[i];
+    sum += values[i];
+    count++;
+  }
+  if (timed.getCount() != count) return false;
+  if (timed.getSum() != sum) return false;
+  if (count == 0) return timed.getFastAverage() == 0;
+  if (timed.getFastAverage() != sum / count) return false;
+  if (timed.getAverage() != sum / count) return false;
+  if (timed.getMinInBuffer() != lo) return false;
+  if (timed.getMaxInBuffer() != hi) return false;
+  return true;
+}
+
+
+unittest(test_timed)
+{
+  static uint16_t values[3000];
+  static uint32_t stamps[3000];
+
+  RunningAverageTimed<> timed(8, 5000);
+  RunningAverageTimed<uint16_t, uint32_t, uint16_t> timed16(8, 5000);
+  timed.setClock(fakeClock);
+  timed16.setClock(fakeClock);
+  assertEqual(5000, timed.getWindow());
+
+  randomSeed(43);
+  fakeNow = 4294960000UL;  //  wraps around during the test
+  for (int i = 0; i < 3000; i++)
+  {
+    //  irregular, with bursts and gaps
+    uint32_t step = (i % 500 < 100) ? 0 : random(50);
+    if (i % 700 == 699) step = 12000;
+    fakeNow += step;
+    values[i] = random(65535);
+    stamps[i] = fakeNow;
+    timed.addValue(values[i]);
+    timed16.addValue(values[i], fakeNow);
+    assertTrue(timedMatches(timed, values, stamps, i + 1, 5000));
+    assertTrue(timedMatches(timed16, values, stamps, i + 1, 5000));
+  }
+  assertTrue(timed.getCapacity() > 8);
+  assertEqual(0, timed.getOverflow());
+
+  //  eviction on query
+  fakeNow += 4999;
+  assertTrue(timed.getCount() > 0);
+  fakeNow += 1;
+  assertEqual(0, timed.getCount());
+  assertEqual(0, timed16.getCount());
+
+  //  16 bit timestamps limit the window
+  timed16.setWindow(100000);
+  assertEqual(32767, timed16.getWindow());
+}
+
+
+unittest(test_histogram)
+{
+  runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_HISTOGRAM> histRA(50);
+  RunningAverage plainRA(50);
+  uint16_t sorted[50];
+
+  randomSeed(47);
+  for (int p = 0; p < 2; p++)
+  {
+    if (p == 1)
+    {
+      histRA.setPartial(21);
+      plainRA.setPartial(21);
+    }
+    for (int i = 0; i < 300; i++)
+    {
+      //  narrow and wide ranges, duplicates
+      uint16_t v = (i % 100 < 50) ? 1000 + random(20) : random(65535);
+      histRA.addValue(v);
+      plainRA.addValue(v);
+
+      uint16_t n = plainRA.getCount();
+      for (uint16_t k = 0; k < n; k++) sorted[k] = plainRA.getValue(k);
+      for (uint16_t a = 1; a < n; a++)
+      {
+        for (uint16_t b = a; b > 0 && sorted[b - 1] > sorted[b]; b--)
+        {
+          uint16_t t = sorted[b]; sorted[b] = sorted[b - 1]; sorted[b - 1] = t;
+        }
+      }
+      for (uint16_t k = 0; k < n; k++)
+      {
+        assertEqual(sorted[k], histRA.getElementByRank(k));
+      }
+      uint16_t median = (n & 1) ? sorted[n / 2] : ((uint32_t)sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+      assertEqual(median, histRA.getMedian());
+      assertEqual(sorted[0], histRA.getQuantile(0));
+      assertEqual(sorted[n - 1], histRA.getQuantile(1.0));
+    }
+  }
+  assertEqual(0, histRA.getElementByRank(21));
+
+  //  fillValue and clear keep the histogram exact
+  histRA.fillValue(500, 10);
+  assertEqual(500, histRA.getMedian());
+  histRA.addValue(100);
+  assertEqual(100, histRA.getQuantile(0));
+  histRA.clear();
+  histRA.addValue(7);
+  assertEqual(7, histRA.getQuantile(0.9));
+
+  //  without the option
+  assertEqual(0, plainRA.getMedian());
+}
+
+
+unittest(test_mode)
+{
+  RunningAverageMode<10> modeRA(40);
+  uint16_t freq[1024];
+
+  randomSeed(53);
+  for (int p = 0; p < 2; p++)
+  {
+    if (p == 1) modeRA.setPartial(15);
+    for (int i = 0; i < 500; i++)
+    {
+      modeRA.addValue(random(12) * 50);  //  many ties
+      memset(freq, 0, sizeof(freq));
+      uint16_t top = 0;
+      for (uint16_t k = 0; k < modeRA.getCount(); k++)
+      {
+        uint16_t f = ++freq[modeRA.getValue(k)];
+        if (f > top) top = f;
+      }
+      assertEqual(top, modeRA.getModeCount());
+      assertEqual(top, freq[modeRA.getMode()]);
+      assertEqual(freq[250], modeRA.getFrequency(250));
+    }
+  }
+
+  //  tie break, the code whose count changed last
+  modeRA.setPartial(4);
+  modeRA.addValue(1);
+  modeRA.addValue(2);
+  modeRA.addValue(2);
+  modeRA.addValue(1);
+  assertEqual(2, modeRA.getModeCount());
+  assertEqual(1, modeRA.getMode());
+  modeRA.addValue(3);   //  evicts a 1
+  assertEqual(2, modeRA.getMode());
+
+  //  fillValue, clipping, clear
+  modeRA.setPartial();
+  modeRA.fillValue(700, 30);
+  assertEqual(700, modeRA.getMode());
+  assertEqual(30, modeRA.getModeCount());
+  modeRA.addValue(5000);  //  counted as 1023
+  assertEqual(1, modeRA.getFrequency(1023));
+  modeRA.clear();
+  assertEqual(0, modeRA.getModeCount());
+  assertEqual(0, modeRA.getMode());
+  modeRA.add(9);
+  assertEqual(9, modeRA.getMode());
+  //  swap takes the counts along
+  RunningAverageMode<10> otherRA(60);
+  otherRA.fillValue(44, 50);
+  modeRA.swap(otherRA);
+  assertEqual(44, modeRA.getMode());
+  assertEqual(50, modeRA.getModeCount());
+  assertEqual(9, otherRA.getMode());
+  assertEqual(0, otherRA.getFrequency(44));
+  for (int i = 0; i < 60; i++) modeRA.addValue(7);
+  assertEqual(7, modeRA.getMode());
+  assertEqual(60, modeRA.getModeCount());
+  assertEqual(0, modeRA.getFrequency(44));
+}
+
+
+unittest(test_exponential)
+{
+  ExponentialAverage<> ea(2);
+  assertEqual(2, ea.getShift());
+  assertEqual(0, ea.getAverage());
+  assertEqual(0, ea.getCount());
+
+  //  first value sets the average
+  ea.addValue(1000);
+  assertEqual(1000, ea.getAverage());
+  assertEqual(1000UL << 16, ea.getRaw());
+
+  //  compare with a float reference, alpha = 0.25
+  float ref = 1000;
+  randomSeed(19);
+  for (int i = 0; i < 2000; i++)
+  {
+    uint16_t v = random(65536);
+    ea.addValue(v);
+    ref += (v - ref) * 0.25;
+    assertTrue(fabs(ea.getAverage() - ref) <= 1.0);
+  }
+  assertEqual(2001, ea.getCount());
+
+  //  converges to a constant input, also downwards
+  for (int i = 0; i < 200; i++) ea.addValue(65535);
+  assertEqual(65535, ea.getAverage());
+  for (int i = 0; i < 200; i++) ea.addValue(7);
+  assertEqual(7, ea.getAverage());
+  assertTrue(ea.getMin() <= 7);
+  assertEqual(65535, ea.getMax());
+
+  ea.fillValue(300);
+  assertEqual(300, ea.getAverage());
+  assertEqual(300, ea.getMin());
+  assertEqual(1, ea.getCount());
+
+  //  shift 0 is no smoothing, shift is clipped to FRAC
+  ea.setShift(0);
+  ea.addValue(12);
+  assertEqual(12, ea.getAverage());
+  ea.setShift(20);
+  assertEqual(16, ea.getShift());
+
+  ExponentialAverage<uint8_t, uint16_t, 8> small(1);
+  small.addValue(200);
+  small.addValue(100);
+  assertEqual(150, small.getAverage());
+  small.clear();
+  assertEqual(0, small.getCount());
+}
+
+
+unittest(test_weighted)
+{
+  using runningaverage::RA_WEIGHTED;
+  runningaverage::RunningAverage<uint16_t, uint32_t, RA_WEIGHTED> wRA(30);
+  runningaverage::RunningAverage<uint16_t, uint32_t> plainRA(30);
+
+  assertEqual(0, wRA.getWeightedAverage());
+
+  //  newest weight 3, oldest weight 1
+  wRA.addValue(10);
+  wRA.addValue(20);
+  wRA.addValue(60);
+  assertEqual(10 + 40 + 180, wRA.getWeightedSum());
+  assertEqual(38, wRA.getWeightedAverage());
+
+  wRA.clear();
+  randomSeed(20);
+  for (int p = 0; p < 2; p++)
+  {
+    if (p == 1)
+    {
+      wRA.setPartial(7);
+      plainRA.setPartial(7);
+    }
+    for (int i = 0; i < 300; i++)
+    {
+      uint16_t v = random(65536);
+      wRA.addValue(v);
+      plainRA.addValue(v);
+      uint32_t ws = 0;
+      for (uint16_t k = 0; k < wRA.getCount(); k++) ws += (uint32_t)wRA.getValue(k) * (k + 1);
+      assertEqual(ws, wRA.getWeightedSum());
+      assertEqual(ws, plainRA.getWeightedSum());
+      assertEqual(plainRA.getWeightedAverage(), wRA.getWeightedAverage());
+    }
+  }
+
+  wRA.setPartial();
+  wRA.fillValue(500, 20);
+  assertEqual(500UL * 210, wRA.getWeightedSum());
+  assertEqual(500, wRA.getWeightedAverage());
+  wRA.addValue(1000);
+  assertEqual(500UL * 210 + 1000UL * 21, wRA.getWeightedSum());
+}
+
+
+unittest(test_lookback)
+{
+  using runningaverage::RA_LOOKBACK;
+  runningaverage::RunningAverage<uint16_t, uint32_t, RA_LOOKBACK> lbRA(300);
+  runningaverage::RunningAverage<uint16_t, uint32_t> plainRA(300);
 
-  assertEqualFloat(990.0, myRA.getMinInBufferLast(10), 0.001);
-  assertEqualFloat(994.5, myRA.getAverageLast(10), 0.001);
-  assertEqualFloat(999.0, myRA.getMaxInBufferLast(10), 0.001);
+  assertTrue(lbRA.addLookback(10));
+  assertTrue(lbRA.addLookback(60));
+  assertFalse(lbRA.addLookback(0));
+  assertFalse(plainRA.addLookback(10));
+  assertEqual(2, lbRA.getLookbacks());
+
+  const uint16_t lengths[4] = { 10, 60, 300, 500 };
+  randomSeed(21);
+  for (int p = 0; p < 2; p++)
+  {
+    if (p == 1)
+    {
+      lbRA.setPartial(45);
+      plainRA.setPartial(45);
+    }
+    for (int i = 0; i < 800; i++)
+    {
+      uint16_t v = random(65536);
+      lbRA.addValue(v);
+      plainRA.addValue(v);
+      //  register later, starts from the buffer
+      if ((p == 0) && (i == 100))
+      {
+        assertTrue(lbRA.addLookback(300));
+        assertTrue(lbRA.addLookback(500));
+        assertFalse(lbRA.addLookback(7));
+      }
+      for (int k = 0; k < 4; k++)
+      {
+        assertEqual(plainRA.getAverageLast(lengths[k]), lbRA.getAverageLast(lengths[k]));
+      }
+    }
+  }
+
+  lbRA.fillValue(400, 30);
+  assertEqual(400, lbRA.getAverageLast(10));
+  assertEqual(400, lbRA.getAverageLast(60));
+  lbRA.addValue(1400);
+  assertEqual(500, lbRA.getAverageLast(10));
+
+  lbRA.clearLookbacks();
+  assertEqual(0, lbRA.getLookbacks());
+  assertEqual(500, lbRA.getAverageLast(10));
+}
+
+
+//  the values of ra equal the newest values of ref, same order
+template <typename RA, typename REF>
+bool keepsNewest(const RA & ra, const REF & ref, uint16_t n)
+{
+  if (ra.getCount() != n) return false;
+  for (uint16_t i = 0; i < n; i++)
+  {
+    if (ra.getValue(i) != ref.getValue(ref.getCount() - n + i)) return false;
+  }
+  return true;
+}
+
+
+unittest(test_resize)
+{
+  using runningaverage::RA_MINMAX;
+  using runningaverage::RA_RANGE;
+  using runningaverage::RA_PREFIX;
+  using runningaverage::RA_WEIGHTED;
+  const uint16_t OPT = RA_MINMAX | RA_RANGE | RA_PREFIX | RA_WEIGHTED;
+  runningaverage::RunningAverage<uint16_t, uint32_t, OPT> optRA(40);
+  RunningAverage ref(400);
+  RunningAverage copyRA(400);
+
+  const uint16_t steps[8] = { 25, 40, 10, 0, 7, 33, 1, 40 };
+  randomSeed(22);
+  for (int s = 0; s < 8; s++)
+  {
+    int adds = random(120);
+    for (int i = 0; i < adds; i++)
+    {
+      uint16_t v = random(10000);
+      optRA.addValue(v);
+      ref.addValue(v);
+    }
+    uint16_t before = optRA.getCount();
+    uint16_t p = (steps[s] == 0) ? 40 : steps[s];
+    optRA.setPartial(steps[s]);
+    uint16_t n = (before < p) ? before : p;
+    assertTrue(keepsNewest(optRA, ref, n));
+
+    //  rebuild the reference of the kept values
+    copyRA.setPartial(1);
+    copyRA.setPartial(0);
+    copyRA.clear();
+    for (uint16_t i = 0; i < n; i++) copyRA.addValue(optRA.getValue(i));
+    assertEqual(copyRA.getSum(), optRA.getSum());
+    assertEqual(copyRA.getMinInBuffer(), optRA.getMinInBuffer());
+    assertEqual(copyRA.getMaxInBuffer(), optRA.getMaxInBuffer());
+    assertEqual(copyRA.getWeightedSum(), optRA.getWeightedSum());
+    assertEqual(copyRA.getAverageLast(5), optRA.getAverageLast(5));
+    assertEqual(copyRA.getMinInBufferLast(3), optRA.getMinInBufferLast(3));
+  }
+
+  //  min / max since clear are kept
+  RunningAverage myRA(10);
+  myRA.fillValue(50, 4);
+  for (int i = 0; i < 10; i++) myRA.addValue(i);
+  myRA.setPartial(3);
+  assertEqual(3, myRA.getCount());
+  assertEqual(8, myRA.getAverage());
+  assertEqual(0, myRA.getMin());
+  assertEqual(50, myRA.getMax());
+
+  //  resize grows and shrinks
+  assertTrue(myRA.resize(100));
+  assertEqual(100, myRA.getSize());
+  assertEqual(100, myRA.getPartial());
+  assertEqual(3, myRA.getCount());
+  for (int i = 10; i < 110; i++) myRA.addValue(i);
+  assertEqual(100, myRA.getCount());
+  assertEqual(59, myRA.getFastAverage());
+  assertTrue(myRA.resize(4));
+  assertEqual(4, myRA.getSize());
+  assertEqual(107, myRA.getAverage());
+  assertEqual(106, myRA.getValue(0));
+  assertFalse(myRA.resize(0));
+
+  runningaverage::RunningAverage<uint16_t, uint32_t, RA_MINMAX | RA_RANGE> rangeRA(5);
+  for (int i = 0; i < 5; i++) rangeRA.addValue(100 - i);
+  assertTrue(rangeRA.resize(300));
+  for (int i = 0; i < 200; i++) rangeRA.addValue(1000 + i);
+  assertEqual(96, rangeRA.getMinInBuffer());
+  assertEqual(96, rangeRA.getMinInBufferSubset(0, 5));
+  assertEqual(1199, rangeRA.getMaxInBufferLast(10));
+
+  //  static
+  RunningAverageStatic<16> staticRA;
+  for (int i = 0; i < 20; i++) staticRA.addValue(i);
+  staticRA.setPartial(5);
+  assertEqual(5, staticRA.getPartial());
+  assertEqual(5, staticRA.getCount());
+  assertEqual(15, staticRA.getValue(0));
+  assertEqual(85, staticRA.getSum());
+  staticRA.addValue(20);
+  assertEqual(16, staticRA.getValue(0));
+  assertEqual(90, staticRA.getSum());
+  assertEqual(18, staticRA.getFastAverage());
+
+  //  mode recounts the kept values
+  RunningAverageMode<8> modeRA(10);
+  for (int i = 0; i < 10; i++) modeRA.addValue(i < 7 ? 3 : 9);
+  modeRA.setPartial(4);
+  assertEqual(3, modeRA.getFrequency(9));
+  assertEqual(9, modeRA.getMode());
+  assertTrue(modeRA.resize(50));
+  for (int i = 0; i < 40; i++) modeRA.addValue(5);
+  assertEqual(5, modeRA.getMode());
+  assertEqual(40, modeRA.getModeCount());
+  assertEqual(3, modeRA.getFrequency(9));
+}
+
+
+//  counting allocator, checks deallocate() gets the allocated size
+static uint32_t hookBytes = 0;
+static uint16_t hookBlocks = 0;
+static bool     hookSizeOk = true;
+
+void * hookAllocate(size_t bytes, void * context)
+{
+  (void) context;
+  uint8_t * p = (uint8_t *) malloc(bytes + sizeof(size_t));
+  if (p == NULL) return NULL;
+  memcpy(p, &bytes, sizeof(size_t));
+  hookBytes += bytes;
+  hookBlocks++;
+  return p + sizeof(size_t);
+}
+
+void hookDeallocate(void * p, size_t bytes, void * context)
+{
+  (void) context;
+  uint8_t * q = (uint8_t *) p - sizeof(size_t);
+  size_t allocated;
+  memcpy(&allocated, q, sizeof(size_t));
+  if (allocated != bytes) hookSizeOk = false;
+  hookBytes -= bytes;
+  hookBlocks--;
+  free(q);
+}
+
+
+unittest(test_allocator)
+{
+  using runningaverage::RA_Allocator;
+  using runningaverage::RA_MINMAX;
+  using runningaverage::RA_RANGE;
+  using runningaverage::RA_PREFIX;
+
+  //  caller owned buffer, never freed by the object
+  static uint16_t buffer[20];
+  {
+    RunningAverage bufRA(20, buffer);
+    assertEqual(20, bufRA.getSize());
+    for (int i = 0; i < 30; i++) bufRA.addValue(i);
+    assertEqual(19, bufRA.getAverage());
+    assertEqual(29, buffer[9]);
+  }
+  {
+    RunningAverage bufRA(20, buffer);
+    for (int i = 0; i < 30; i++) bufRA.addValue(i);
+    //  growing moves to allocated memory, the old buffer is left alone
+    assertTrue(bufRA.resize(40));
+    assertEqual(20, bufRA.getCount());
+    assertEqual(19, bufRA.getAverage());
+  }
+
+  RA_Allocator hooks = { hookAllocate, hookDeallocate, NULL };
+  {
+    const uint16_t OPT = RA_MINMAX | RA_RANGE | RA_PREFIX;
+    runningaverage::RunningAverage<uint16_t, uint32_t, OPT> hookRA(50, hooks);
+    assertEqual(4, hookBlocks);
+    assertEqual(50UL * (2 + 4 + 4 + 8), hookBytes);
+    for (int i = 0; i < 80; i++) hookRA.addValue(i);
+    assertEqual(54, hookRA.getAverage());
+
+    //  shrink keeps the memory, growing within it does not allocate
+    assertTrue(hookRA.resize(10));
+    assertEqual(50UL * 18, hookBytes);
+    assertTrue(hookRA.resize(50));
+    assertEqual(50UL * 18, hookBytes);
+    assertEqual(10, hookRA.getCount());
+    assertEqual(74, hookRA.getAverage());
+
+    assertTrue(hookRA.resize(100));
+    assertEqual(4, hookBlocks);
+    assertEqual(100UL * 18, hookBytes);
+    for (int i = 80; i < 200; i++) hookRA.addValue(i);
+    assertEqual(149, hookRA.getAverage());
+    assertEqual(100, hookRA.getMinInBuffer());
+    assertEqual(190, hookRA.getMinInBufferLast(10));
+  }
+  assertEqual(0, hookBlocks);
+  assertEqual(0, hookBytes);
+  assertTrue(hookSizeOk);
+
+  //  one block per buffer
+  {
+    runningaverage::RunningAverage<uint16_t, uint32_t, RA_MINMAX> mixRA(5, hooks);
+    assertEqual(2, hookBlocks);
+  }
+  assertEqual(0, hookBlocks);
+}
+
+
+unittest(test_move_copy)
+{
+  using runningaverage::RA_MINMAX;
+  using runningaverage::RA_RANGE;
+  using runningaverage::RA_PREFIX;
+  using runningaverage::RA_QUOTIENT;
+  const uint16_t OPT = RA_MINMAX | RA_RANGE | RA_PREFIX | RA_QUOTIENT;
+  typedef runningaverage::RunningAverage<uint16_t, uint32_t, OPT> OptRA;
+
+  OptRA a(30);
+  a.fillValue(500, 10);
+  for (int i = 0; i < 12; i++) a.addValue(i * 10);
+
+  //  deep copy, independent
+  OptRA b(a);
+  assertTrue(sameState(a, b));
+  b.addValue(9999);
+  assertEqual(22, a.getCount());
+  assertEqual(9999, b.getMaxInBuffer());
+  assertEqual(500, a.getMaxInBuffer());
+  assertTrue(a.getSum() != b.getSum());
+
+  OptRA c(5);
+  c = a;
+  assertEqual(30, c.getSize());
+  assertTrue(sameState(a, c));
+  c = c;
+  assertTrue(sameState(a, c));
+
+  //  move takes the buffers, source is empty
+  OptRA d(static_cast<OptRA &&>(c));
+  assertTrue(sameState(a, d));
+  assertEqual(0, c.getSize());
+  assertEqual(0, c.getCount());
+  c.addValue(5);
+  assertEqual(0, c.getCount());
+
+  OptRA e(3);
+  e = static_cast<OptRA &&>(d);
+  assertTrue(sameState(a, e));
+  assertEqual(0, d.getSize());
+
+  //  swap
+  OptRA f(7);
+  f.addValue(77);
+  f.swap(e);
+  assertTrue(sameState(a, f));
+  assertEqual(77, e.getAverage());
+  assertEqual(7, e.getSize());
+  for (int i = 0; i < 50; i++) f.addValue(i);
+  assertEqual(20, f.getMinInBuffer());
+  assertEqual(39, f.getAverageLast(21));
+
+  //  copy of a caller buffer allocates
+  uint16_t buffer[8];
+  RunningAverage g(8, buffer);
+  g.addValue(3);
+  RunningAverage h(g);
+  h.addValue(5);
+  assertEqual(3, buffer[0]);
+  assertEqual(1, g.getCount());
+  assertEqual(4, h.getAverage());
+
+  //  contiguous windows in a vector
+  std::vector<OptRA> channels;
+  for (int ch = 0; ch < 20; ch++)
+  {
+    channels.push_back(OptRA(10 + ch));
+    channels.back().addValue(ch);
+  }
+  for (int ch = 0; ch < 20; ch++)
+  {
+    assertEqual(ch, channels[ch].getAverage());
+    assertEqual(10 + ch, channels[ch].getSize());
+  }
+  static_assert(std::is_nothrow_move_constructible<OptRA>::value, "move");
+}
+
+
+unittest(test_serialize)
+{
+  using runningaverage::RA_MINMAX;
+  using runningaverage::RA_RANGE;
+  using runningaverage::RA_PREFIX;
+  using runningaverage::RA_HISTOGRAM;
+  using runningaverage::RA_WEIGHTED;
+  const uint16_t OPT = RA_MINMAX | RA_RANGE | RA_PREFIX | RA_HISTOGRAM | RA_WEIGHTED;
+  typedef runningaverage::RunningAverage<uint16_t, uint32_t, OPT> OptRA;
+
+  OptRA a(40);
+  a.setPartial(30);
+  a.fillValue(800, 12);
+  randomSeed(25);
+  for (int i = 0; i < 25; i++) a.addValue(random(2000));
+
+  //  header 14 + sum 4 + min 2 + max 2 = 22 ==> 24, + 80 ring
+  assertEqual(104, a.serializedSize());
+  uint64_t store[16];
+  uint8_t * blob = (uint8_t *) store;
+  assertEqual(0, a.serialize(blob, 100));
+  assertEqual(104, a.serialize(blob, sizeof(store)));
+  assertEqual('R', blob[0]);
+  assertEqual('A', blob[1]);
+  assertEqual(1, blob[2]);
+  assertEqual(40, blob[6]);   //  size, little endian
+  assertEqual(0, blob[7]);
+
+  //  restore resizes and rebuilds the options
+  OptRA b(5);
+  assertTrue(b.deserialize(blob, 104));
+  assertEqual(40, b.getSize());
+  assertEqual(30, b.getPartial());
+  //  the rebuild keeps the layout of the ring.
+  assertTrue(sameState(a, b));
+  assertEqual(a.getMedian(), b.getMedian());
+  assertEqual(a.getWeightedSum(), b.getWeightedSum());
+  a.addValue(1234);
+  b.addValue(1234);
+  assertTrue(sameState(a, b));
+
+  //  plain, attach uses the ring in the blob
+  RunningAverage c(50);
+  for (int i = 0; i < 70; i++) c.addValue(i);
+  uint64_t plainStore[16];
+  uint8_t * plain = (uint8_t *) plainStore;
+  size_t bytes = c.serialize(plain, sizeof(plainStore));
+  assertEqual(24 + 100 + 4, bytes);
+  RunningAverage d(1);
+  assertTrue(d.attach(plain, bytes));
+  assertTrue(sameState(c, d));
+  d.addValue(1000);
+  assertEqual(1000, ((uint16_t *)(plain + 24))[20]);
+
+  //  invalid blobs
+  RunningAverage e(10);
+  e.addValue(3);
+  assertFalse(e.deserialize(plain, 50));      //  too short
+  assertFalse(e.attach(plain + 1, bytes));   //  no magic
+  assertEqual(1, e.getCount());                //  attach leaves it unchanged
+  plain[10] = 60;                              //  count > partial
+  assertFalse(e.deserialize(plain, bytes));
+  plain[10] = 50;
+  plain[20] ^= 1;                              //  sample changed, sum mismatch
+  assertFalse(e.deserialize(plain, bytes));
+  assertEqual(0, e.getCount());
+  runningaverage::RunningAverage<uint16_t, uint64_t> wide(10);
+  assertFalse(wide.deserialize(blob, 104));   //  other accumulator
+
+  //  mode recounts
+  RunningAverageMode<6> modeA(20);
+  for (int i = 0; i < 30; i++) modeA.addValue(i % 7);
+  uint64_t modeStore[8];
+  assertEqual(64, modeA.serialize((uint8_t *)modeStore, sizeof(modeStore)));
+  RunningAverageMode<6> modeB(4);
+  assertTrue(modeB.deserialize((uint8_t *)modeStore, 64));
+  assertEqual(modeA.getMode(), modeB.getMode());
+  assertEqual(modeA.getModeCount(), modeB.getModeCount());
+  for (int v = 0; v < 7; v++) assertEqual(modeA.getFrequency(v), modeB.getFrequency(v));
+
+  //  attach keeps the settings of the object, like deserialize
+  using runningaverage::RA_LOOKBACK;
+  using runningaverage::RA_ROUND_NEAREST;
+  typedef runningaverage::RunningAverage<uint16_t, uint32_t, RA_LOOKBACK> LookRA;
+  LookRA src(8);
+  src.addValue(1);
+  src.addValue(2);
+  uint64_t lookStore[8];
+  size_t lookBytes = src.serialize((uint8_t *)lookStore, sizeof(lookStore));
+  uint64_t lookCopy[8];
+  memcpy(lookCopy, lookStore, sizeof(lookStore));
+  LookRA viaCopy(4);
+  LookRA viaAttach(4);
+  viaCopy.setRounding(RA_ROUND_NEAREST);
+  viaAttach.setRounding(RA_ROUND_NEAREST);
+  assertTrue(viaCopy.addLookback(2));
+  assertTrue(viaAttach.addLookback(2));
+  assertTrue(viaCopy.deserialize((uint8_t *)lookStore, lookBytes));
+  assertTrue(viaAttach.attach((uint8_t *)lookCopy, lookBytes));
+  assertEqual(RA_ROUND_NEAREST, viaAttach.getRounding());
+  assertEqual(1, viaAttach.getLookbacks());
+  assertEqual(2, viaCopy.getFastAverage());
+  assertEqual(viaCopy.getFastAverage(), viaAttach.getFastAverage());
+  viaCopy.addValue(9);
+  viaAttach.addValue(9);
+  assertEqual(5, viaAttach.getAverageLast(2));
+  assertEqual(viaCopy.getAverageLast(2), viaAttach.getAverageLast(2));
+
+  //  with options attach does not change the blob, it can be attached again
+  OptRA wrapped(10);
+  for (int i = 0; i < 17; i++) wrapped.addValue(i);
+  uint64_t wrapStore[8];
+  size_t wrapBytes = wrapped.serialize((uint8_t *)wrapStore, sizeof(wrapStore));
+  uint64_t wrapCopy[8];
+  memcpy(wrapCopy, wrapStore, sizeof(wrapStore));
+  OptRA firstRA(4);
+  OptRA secondRA(4);
+  assertTrue(firstRA.attach((uint8_t *)wrapStore, wrapBytes));
+  assertEqual(0, memcmp(wrapCopy, wrapStore, wrapBytes));
+  assertTrue(secondRA.attach((uint8_t *)wrapStore, wrapBytes));
+  assertEqual(7, firstRA.getValue(0));
+  assertEqual(7, secondRA.getValue(0));
+  assertTrue(sameState(wrapped, secondRA));
+  assertEqual(wrapped.getMedian(), secondRA.getMedian());
+  assertEqual(wrapped.getWeightedSum(), secondRA.getWeightedSum());
+
+  //  invalid header leaves the object unchanged
+  assertFalse(viaCopy.deserialize((uint8_t *)lookStore + 1, lookBytes));
+  assertEqual(3, viaCopy.getCount());
+
+  //  a moved from object can be restored
+  LookRA moved(static_cast<LookRA &&>(viaCopy));
+  assertEqual(0, viaCopy.getSize());
+  assertTrue(viaCopy.deserialize((uint8_t *)lookStore, lookBytes));
+  assertEqual(8, viaCopy.getSize());
+  assertEqual(2, viaCopy.getCount());
+  viaCopy.addValue(6);
+  assertEqual(3, viaCopy.getAverage());
+  runningaverage::RunningAverage<uint16_t, uint32_t, RA_HISTOGRAM> histA(6);
+  histA.addValue(10);
+  histA.addValue(30);
+  uint64_t histStore[8];
+  size_t histBytes = histA.serialize((uint8_t *)histStore, sizeof(histStore));
+  runningaverage::RunningAverage<uint16_t, uint32_t, RA_HISTOGRAM> histB(static_cast<runningaverage::RunningAverage<uint16_t, uint32_t, RA_HISTOGRAM> &&>(histA));
+  assertTrue(histA.deserialize((uint8_t *)histStore, histBytes));
+  assertEqual(20, histA.getMedian());
+
+#if defined(RA_HAS_MMAP)
+  //  many windows, one file
+  const uint16_t WINDOWS = 1000;
+  std::vector<RunningAverage> windows;
+  for (uint16_t w = 0; w < WINDOWS; w++)
+  {
+    windows.push_back(RunningAverage(10 + w % 50));
+    for (uint16_t i = 0; i < w % 80; i++) windows[w].addValue(w + i);
+  }
+  const char * path = "/tmp/ra_unit_test_windows.bin";
+  assertTrue(runningaverage::ra_saveWindows(path, windows.data(), WINDOWS));
+
+  std::vector<RunningAverage> restored(WINDOWS, RunningAverage(1));
+  {
+    RunningAverageFile file;
+    assertTrue(file.open(path));
+    assertEqual(WINDOWS, file.restore(restored.data(), WINDOWS));
+    bool same = true;
+    for (uint16_t w = 0; w < WINDOWS; w++)
+    {
+      same = same && sameState(windows[w], restored[w]);
+      restored[w].addValue(7);
+      windows[w].addValue(7);
+      same = same && sameState(windows[w], restored[w]);
+    }
+    assertTrue(same);
+    //  the windows use the mapping, release them before the file
+    restored.clear();
+  }
+  //  the file is not changed by the updates
+  RunningAverageFile again;
+  assertTrue(again.open(path));
+  RunningAverage first(1);
+  assertEqual(1, again.restore(&first, 1));
+  assertEqual(0, first.getCount());
+  assertFalse(again.open("/tmp/ra_unit_test_does_not_exist.bin"));
+  unlink(path);
+#endif
+}
+
+
+unittest(test_object_size)
+{
+  using runningaverage::RA_Allocator;
+  typedef runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_MOMENTS>  MomentsRA;
+  typedef runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_MOMENTS4> Moments4RA;
+  typedef runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_WEIGHTED> WeightedRA;
+  typedef runningaverage::RunningAverage<uint16_t, uint32_t, runningaverage::RA_HISTOGRAM> HistogramRA;
 
-  assertEqualFloat(900.0, myRA.getMinInBufferLast(100), 0.001);
-  assertEqualFloat(949.5, myRA.getAverageLast(100), 0.001);
-  assertEqualFloat(999.0, myRA.getMaxInBufferLast(100), 0.001);
+  //  no option state without options, only alignment padding on top.
+  size_t core = sizeof(uint16_t *) + sizeof(RA_Allocator) + sizeof(uint32_t)
+              + 7 * sizeof(uint16_t) + 3 * sizeof(uint16_t) + 2;
+  assertTrue(sizeof(RunningAverage) >= core);
+  assertTrue(sizeof(RunningAverage) < core + sizeof(void *));
 
-  assertEqualFloat(700.0, myRA.getMinInBufferLast(1000), 0.001);
-  assertEqualFloat(849.5, myRA.getAverageLast(1000), 0.001);
-  assertEqualFloat(999.0, myRA.getMaxInBufferLast(1000), 0.001);
+  //  an option adds its own state only.
+  assertTrue(sizeof(MomentsRA)   <= sizeof(RunningAverage) + 8);
+  assertTrue(sizeof(Moments4RA)  <= sizeof(RunningAverage) + 24);
+  assertTrue(sizeof(WeightedRA)  <= sizeof(RunningAverage) + sizeof(void *));
+  assertTrue(sizeof(HistogramRA) <= sizeof(RunningAverage) + sizeof(void *));
 }
 
 
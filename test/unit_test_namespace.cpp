@@ -0,0 +1,65 @@
+//
+//    FILE: unit_test_namespace.cpp
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.1.0
+//    DATE: 2026-10-16
+// PURPOSE: compile check, using namespace runningaverage without the global names
+//          https://github.com/RobTillaart/RunningAverage
+//
+
+
+#include <ArduinoUnitTests.h>
+
+#include "Arduino.h"
+
+//  without this the global names are ambiguous with the namespace ones.
+#define RA_NO_GLOBAL_NAMES
+#include "RunningAverage.h"
+#include "RunningAverageStatic.h"
+#include "RunningAverageBank.h"
+#include "RunningAverageFrame.h"
+#include "RunningAverageQueue.h"
+#include "RunningAverageSnapshot.h"
+#include "RunningAverageCascade.h"
+#include "RunningAverageTimed.h"
+#include "RunningAverageMode.h"
+#include "ExponentialAverage.h"
+#include "RunningAverageFile.h"
+
+using namespace runningaverage;
+
+
+unittest_setup()
+{
+}
+
+unittest_teardown()
+{
+}
+
+
+unittest(test_using_namespace)
+{
+  RunningAverage<> ra(4);
+  RunningAverage<uint16_t, uint32_t, RA_MINMAX> mmRA(4);
+  RunningAverageStatic<8> staticRA;
+  ExponentialAverage<> ea(2);
+
+  for (int i = 1; i <= 4; i++)
+  {
+    ra.addValue(i);
+    mmRA.addValue(i);
+    staticRA.addValue(i);
+    ea.addValue(i);
+  }
+  assertEqual(10, ra.getSum());
+  assertEqual(4, mmRA.getMaxInBuffer());
+  assertEqual(10, staticRA.getSum());
+  assertTrue(ea.getAverage() > 0);
+}
+
+
+unittest_main()
+
+
+// --------